@@ -21,6 +21,9 @@
 
 DeclareGlobalFunction( "_SI_BindSingularProcs" );
 
+# Resolve a Singular proc once, for faster calls via SI_CallProc
+DeclareGlobalFunction( "SI_ProcHandle" );
+
 DeclareOperation( "Singular", [IsStringRep] );
 DeclareOperation( "Singular", [IsString and IsEmpty] );
 DeclareOperation( "Singular", [] );
@@ -29,3 +32,6 @@ DeclareGlobalFunction( "SingularLastError" );
 
 # Useful little helper to undefine a Singular var or proc
 DeclareGlobalFunction( "SingularUnbind" );
+
+# Apply one Singular operation to many argument tuples in a single call
+DeclareGlobalFunction( "SI_CallBatch" );
@@ -24,6 +24,9 @@ DeclareGlobalFunction( "_SI_Addition_fast" );
 DeclareGlobalFunction( "_SI_Subtraction" );
 DeclareGlobalFunction( "_SI_Negation" );
 DeclareGlobalFunction( "_SI_Negation_fast" );
+DeclareGlobalFunction( "_SI_Multiplication" );
+DeclareGlobalFunction( "_SI_Power" );
+DeclareGlobalFunction( "_SI_SumPolys" );
 
 DeclareOperation("SI_bigint",[IsSI_Object]);
 DeclareOperation("SI_bigint",[IsInt]);
@@ -43,6 +46,7 @@ DeclareOperation("SI_intmat",[IsList]);
 
 DeclareOperation("SI_poly",[IsSI_ring, IsSI_Object]);
 DeclareOperation("SI_poly",[IsSI_ring, IsStringRep]);
+DeclareOperation("SI_poly",[IsSI_ring, IsList, IsList]);
 
 DeclareOperation("SI_matrix",[IsSI_Object]);
 DeclareOperation("SI_matrix",[IsSI_Object, IsPosInt, IsPosInt]);
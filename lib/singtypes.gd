@@ -45,7 +45,10 @@ DeclareCategory( "IsSI_ring", IsSI_Object and IsAdditiveMagmaWithZero
                   and IsRingWithOne );
 DeclareCategory( "IsSI_string", IsSI_Object and IsHomogeneousList );
 DeclareCategory( "IsSI_vector", IsSI_Object and IsHomogeneousList );
+DeclareCategory( "IsSI_PolyAccumulator", IsSI_Object );
 DeclareCategory( "IsSI_proxy", IsPositionalObjectRep and IsSI_Object );
+DeclareCategory( "IsSI_procHandle", IsPositionalObjectRep );
+DeclareCategory( "IsSI_failure", IsPositionalObjectRep );
 
 _SI_Types := [];
 
@@ -117,10 +120,23 @@ _SI_Types[_SI_TYPENRS.SINGTYPE_VECTOR]
    := NewType(SingularFamily,IsSI_vector and IsMutable);
 _SI_Types[_SI_TYPENRS.SINGTYPE_VECTOR_IMM]
    := NewType(SingularFamily,IsSI_vector);
+_SI_Types[_SI_TYPENRS.SINGTYPE_POLYACC]
+   := NewType(SingularFamily,IsSI_PolyAccumulator and IsMutable);
+_SI_Types[_SI_TYPENRS.SINGTYPE_POLYACC_IMM]
+   := NewType(SingularFamily,IsSI_PolyAccumulator);
 
 BindGlobal("_SI_ProxiesType",
   NewType( SingularFamily, IsSI_proxy and IsMutable));
 
+BindGlobal("_SI_ProcHandleType",
+  NewType( SingularFamily, IsSI_procHandle ));
+
+# Returned instead of fail by Singular calls which were aborted because
+# they exceeded the limit set by SI_SetMemoryLimit.
+BindGlobal("SI_MemoryLimitExceeded",
+  Objectify( NewType( SingularFamily, IsSI_failure ),
+             [ "memory limit exceeded" ] ));
+
 DeclareOperation( "_SI_TypeName", [IsSI_Object] );
 
 # HACK: The following is only there because we explicitly referred to
@@ -0,0 +1,259 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "accumulator.h"
+#include "arith.h"
+#include "cleanup.h"
+#include "memory.h"
+
+#include <polys/kbuckets.h>
+
+
+//////////////// Polynomial accumulators ////////////////////
+
+// A polynomial accumulator (SINGTYPE_POLYACC) wraps a Singular geobucket
+// (kBucket). A geobucket keeps its polynomial as a sum of buckets of
+// geometrically growing lengths, and a new summand is only merged with
+// a bucket of similar length. Summing n polynomials thus needs
+// O(n log n) term comparisons, instead of O(n^2) when adding them up
+// one by one with p_Add_q.
+//
+// The bucket has no counterpart in the Singular interpreter, so
+// accumulators cannot be passed to Singular functions; use
+// SI_AccumulatorResult to get their value as a polynomial. As the
+// summands are not reduced modulo a quotient ideal, accumulators over
+// quotient rings are not supported.
+
+// Return the bucket of the accumulator a, which must be mutable if it
+// is going to be modified.
+static kBucket_pt GetBucket(Obj a, bool modify)
+{
+    if (TNUM_OBJ(a) != T_SINGULAR ||
+        (TYPE_SINGOBJ(a) & ~1) != SINGTYPE_POLYACC)
+        _SI_ErrorQuit("<a> must be a polynomial accumulator", 0L, 0L);
+    if (modify && !IS_MUTABLE_OBJ(a))
+        _SI_ErrorQuit("<a> must be mutable", 0L, 0L);
+    return (kBucket_pt)CXX_SINGOBJ(a);
+}
+
+static poly GetSummand(Obj p, ring r)
+{
+    if (TNUM_OBJ(p) != T_SINGULAR ||
+        (TYPE_SINGOBJ(p) & ~1) != SINGTYPE_POLY)
+        _SI_ErrorQuit("<p> must be a polynomial", 0L, 0L);
+    if (CXXRING_SINGOBJ(p) != r)
+        _SI_ErrorQuit("<a> and <p> must be defined over the same ring", 0L, 0L);
+    return (poly)CXX_SINGOBJ(p);
+}
+
+//! Free the bucket of a dead accumulator. This is called by
+//! _SI_FreeFunc; like other Singular objects, the polynomials in the
+//! buckets are queued and freed later, see _SI_QueueFree.
+void _SI_FreeAccumulator(void *data, ring r, UInt bytes)
+{
+    kBucket_pt b = (kBucket_pt)data;
+    for (int i = 0; i <= b->buckets_used; i++) {
+        if (b->buckets[i] != NULL) {
+            _SI_QueueFree(POLY_CMD, b->buckets[i], 0, NULL, r, bytes);
+            bytes = 0;
+        }
+#ifdef USE_COEF_BUCKETS
+        if (b->coef[i] != NULL)
+            _SI_QueueFree(POLY_CMD, b->coef[i], 0, NULL, r, 0);
+#endif
+    }
+    kBucketDestroy(&b);
+}
+
+//! Return a copy of the bucket of an accumulator, for ShallowCopy. As a
+//! side effect, the buckets of the original are merged into one.
+void *_SI_CopyAccumulator(void *data, ring r)
+{
+    kBucket_pt b = (kBucket_pt)data;
+    poly p;
+    int l;
+    kBucketClear(b, &p, &l);
+    kBucketInit(b, p, l);
+    kBucket_pt c = kBucketCreate(r);
+    kBucketInit(c, p_Copy(p, r), l);
+    return c;
+}
+
+//! Return the estimated number of bytes used by the polynomials in the
+//! bucket of an accumulator.
+UInt _SI_ByteSizeOfAccumulator(void *data, ring r)
+{
+    kBucket_pt b = (kBucket_pt)data;
+    UInt bytes = 0;
+    for (int i = 0; i <= b->buckets_used; i++)
+        bytes += _SI_ByteSizeOfPoly(b->buckets[i], r);
+    return bytes;
+}
+
+//! Create a new, empty polynomial accumulator over the ring rr.
+Obj FuncSI_PolyAccumulator(Obj self, Obj rr)
+{
+    rr = UnwrapHighlevelWrapper(rr);
+    if (!ISSINGOBJ(SINGTYPE_RING_IMM, rr) && !ISSINGOBJ(SINGTYPE_QRING_IMM, rr))
+        _SI_ErrorQuit("argument must be a Singular ring", 0L, 0L);
+    ring r = (ring)CXX_SINGOBJ(rr);
+    if (r->qideal != NULL)
+        _SI_ErrorQuit("argument must not be a quotient ring", 0L, 0L);
+    Obj a = NEW_SINGOBJ_RING(SINGTYPE_POLYACC, kBucketCreate(r), r);
+    _SI_SetWrapperBytes(a, 0);
+    return a;
+}
+
+//! Add the polynomial p to the accumulator a.
+Obj FuncSI_AccumulatorAdd(Obj self, Obj a, Obj p)
+{
+    kBucket_pt b = GetBucket(a, true);
+    ring r = CXXRING_SINGOBJ(a);
+    poly q = GetSummand(p, r);
+    if (q == NULL)
+        return 0;
+
+    if (r != currRing)
+        rChangeCurrRing(r);
+    UInt bytes = _SI_ByteSizeOfPoly(q, r);
+    q = p_Copy(q, r);
+    int l = pLength(q);
+    kBucket_Add_q(b, q, &l);
+    // Cancellations are only taken into account by SI_AccumulatorResult.
+    _SI_SetWrapperBytes(a, BYTES_SINGOBJ(a) + bytes);
+    return 0;
+}
+
+//! Add c*m*p to the accumulator a, where c is a scalar and m a monomial.
+Obj FuncSI_AccumulatorAddScaled(Obj self, Obj a, Obj c, Obj m, Obj p)
+{
+    kBucket_pt b = GetBucket(a, true);
+    ring r = CXXRING_SINGOBJ(a);
+    poly q = GetSummand(p, r);
+    _SI_CheckScalar(c, r);
+    if (!_SI_IsMonomial(m, r))
+        _SI_ErrorQuit("<m> must be a monomial over the ring of <a>", 0L, 0L);
+    poly mon = (poly)CXX_SINGOBJ(m);
+    _SI_CheckExponents(q, mon, r);
+    if (q == NULL)
+        return 0;
+
+    if (r != currRing)
+        rChangeCurrRing(r);
+    number n = _SI_ScalarFromObj(c, r);
+    if (n_IsZero(n, r->cf)) {
+        n_Delete(&n, r->cf);
+        return 0;
+    }
+    mon = p_Mult_nn(p_Head(mon, r), n, r);
+    n_Delete(&n, r->cf);
+    kBucket_Plus_mm_Mult_pp(b, mon, q, pLength(q));
+    p_Delete(&mon, r);
+    _SI_SetWrapperBytes(a, BYTES_SINGOBJ(a) + _SI_ByteSizeOfPoly(q, r));
+    return 0;
+}
+
+//! Return the current value of the accumulator a as a new, mutable
+//! polynomial. The accumulator itself is not changed, so more summands
+//! may be added afterwards.
+Obj FuncSI_AccumulatorResult(Obj self, Obj a)
+{
+    kBucket_pt b = GetBucket(a, false);
+    ring r = CXXRING_SINGOBJ(a);
+    if (r != currRing)
+        rChangeCurrRing(r);
+    poly p;
+    int l;
+    kBucketClear(b, &p, &l);
+    kBucketInit(b, p, l);
+    UInt bytes = _SI_ByteSizeOfPoly(p, r);
+    _SI_SetWrapperBytes(a, bytes);
+    return NEW_SINGOBJ_RING(SINGTYPE_POLY, p_Copy(p, r), r);
+}
+
+
+//////////////// Linear combinations ////////////////////
+
+static void CleanupBucket(void *arg, ring r)
+{
+    kBucketDeleteAndDestroy((kBucket_pt *)arg);
+}
+
+//! Return the linear combination of the polynomials or vectors in the
+//! list polys with the scalars in the list coeffs. The summands are
+//! collected in a single geobucket, so that no temporary wrappers are
+//! created. The result is immutable if all arguments are immutable.
+Obj FuncSI_LinearCombination(Obj self, Obj coeffs, Obj polys)
+{
+    if (!IS_DENSE_LIST(coeffs) || !IS_DENSE_LIST(polys))
+        _SI_ErrorQuit("<coeffs> and <polys> must be dense lists", 0L, 0L);
+    UInt len = LEN_LIST(polys);
+    if (LEN_LIST(coeffs) != len)
+        _SI_ErrorQuit("<coeffs> and <polys> must have the same length", 0L, 0L);
+    if (len == 0)
+        _SI_ErrorQuit("<polys> must not be empty", 0L, 0L);
+
+    Obj p = ELM_LIST(polys, 1);
+    if (TNUM_OBJ(p) != T_SINGULAR ||
+        ((TYPE_SINGOBJ(p) & ~1) != SINGTYPE_POLY &&
+         (TYPE_SINGOBJ(p) & ~1) != SINGTYPE_VECTOR))
+        _SI_ErrorQuit("<polys> must contain polynomials or vectors", 0L, 0L);
+    UInt type = TYPE_SINGOBJ(p) & ~1;
+    ring r = CXXRING_SINGOBJ(p);
+    bool immutable = true;
+    for (UInt i = 1; i <= len; i++) {
+        p = ELM_LIST(polys, i);
+        if (TNUM_OBJ(p) != T_SINGULAR || (TYPE_SINGOBJ(p) & ~1) != type ||
+            CXXRING_SINGOBJ(p) != r)
+            _SI_ErrorQuit("the entries of <polys> must have the same type and ring",
+                          0L, 0L);
+        Obj c = ELM_LIST(coeffs, i);
+        if (TNUM_OBJ(c) == T_SINGULAR &&
+            ((TYPE_SINGOBJ(c) & ~1) != SINGTYPE_NUMBER || CXXRING_SINGOBJ(c) != r))
+            _SI_ErrorQuit("<coeffs> must contain scalars over the ring of <polys>",
+                          0L, 0L);
+        if (IS_MUTABLE_OBJ(p) || (TNUM_OBJ(c) == T_SINGULAR && IS_MUTABLE_OBJ(c)))
+            immutable = false;
+    }
+
+    if (r != currRing)
+        rChangeCurrRing(r);
+    CleanupScope scope;
+    kBucket_pt b = kBucketCreate(r);
+    _SI_AddCleanup(CleanupBucket, &b, r);
+    for (UInt i = 1; i <= len; i++) {
+        poly q = (poly)CXX_SINGOBJ(ELM_LIST(polys, i));
+        if (q == NULL)
+            continue;
+        // converting a GAP number may raise an error
+        number n = _SI_ScalarFromObj(ELM_LIST(coeffs, i), r);
+        poly m = p_NSet(n, r);      // NULL if n is zero
+        if (m != NULL) {
+            kBucket_Plus_mm_Mult_pp(b, m, q, pLength(q));
+            p_Delete(&m, r);
+        }
+    }
+    poly res;
+    int l;
+    kBucketClear(b, &res, &l);
+    kBucketDestroy(&b);
+    return NEW_SINGOBJ_RING(immutable ? type | 1 : type, res, r);
+}
@@ -0,0 +1,37 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef LIBSING_ACCUMULATOR_H
+#define LIBSING_ACCUMULATOR_H
+
+#include "libsing.h"
+
+void _SI_FreeAccumulator(void *data, ring r, UInt bytes);
+void *_SI_CopyAccumulator(void *data, ring r);
+UInt _SI_ByteSizeOfAccumulator(void *data, ring r);
+
+Obj FuncSI_PolyAccumulator(Obj self, Obj rr);
+Obj FuncSI_AccumulatorAdd(Obj self, Obj a, Obj p);
+Obj FuncSI_AccumulatorAddScaled(Obj self, Obj a, Obj c, Obj m, Obj p);
+Obj FuncSI_AccumulatorResult(Obj self, Obj a);
+Obj FuncSI_LinearCombination(Obj self, Obj coeffs, Obj polys);
+
+#endif
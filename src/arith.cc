@@ -0,0 +1,576 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "arith.h"
+#include "memory.h"
+#include "number.h"
+
+#include <polys/matpol.h>
+
+#include <limits.h>
+
+extern "C" Obj SumObject(Obj opL, Obj opR);
+extern "C" Obj DiffObject(Obj opL, Obj opR);
+extern "C" Obj ProdObject(Obj opL, Obj opR);
+extern "C" Obj QuoObject(Obj opL, Obj opR);
+extern "C" Obj PowObject(Obj opL, Obj opR);
+extern "C" Obj AInvObject(Obj op);
+
+
+//////////////// Arithmetic without method selection ////////////////////
+
+// The following functions are installed in the arithmetic jump tables
+// of the GAP kernel (SumFuncs, ...). For polynomials, vectors, numbers,
+// bigints, matrices and ideals they call the Singular kernel directly;
+// everything else, as well as errors like operands over different rings
+// or matrices of incompatible size, is left to the generic GAP methods
+// (see lib/arith.gi), i.e., to the Singular interpreter. This includes
+// all polynomial arithmetic over quotient rings, where the interpreter
+// reduces the results modulo the quotient ideal.
+//
+// The result is immutable if all operands are immutable, and mutable
+// otherwise; small integers count as immutable.
+
+enum { OP_SUM, OP_DIFF, OP_PROD, OP_QUO };
+
+// A binary operation on two wrapped objects of the same type over the
+// same ring, or on a wrapped object and a small integer, which is then
+// converted to the type of the other operand.
+struct Operands {
+    UInt type;      // the mutable GAP type of the operands
+    ring r;
+    void *x, *y;
+    bool tmpx, tmpy;    // true if x resp. y was converted from an integer
+};
+
+static inline bool IsImmutableOperand(Obj a)
+{
+    return TNUM_OBJ(a) != T_SINGULAR || (TYPE_SINGOBJ(a) & 1);
+}
+
+static Obj WrapResult(UInt type, void *data, ring r, bool immutable)
+{
+    if (immutable)
+        type |= 1;
+    if (HasRingTable[type])
+        return NEW_SINGOBJ_RING(type, data, r);
+    return NEW_SINGOBJ(type, data);
+}
+
+// Convert a small integer to a temporary object of the given type.
+static bool IntToSing(Obj i, UInt type, ring r, void **res)
+{
+    long n = INT_INTOBJ(i);
+    switch (type) {
+        case SINGTYPE_POLY:
+            *res = p_ISet(n, r);
+            return true;
+        case SINGTYPE_NUMBER:
+            *res = n_Init(n, r->cf);
+            return true;
+        case SINGTYPE_BIGINT:
+            *res = n_Init(n, coeffs_BIGINT);
+            return true;
+    }
+    return false;
+}
+
+static void FreeTemp(UInt type, void *data, ring r)
+{
+    if (type == SINGTYPE_POLY) {
+        poly p = (poly)data;
+        p_Delete(&p, r);
+    } else {
+        number n = (number)data;
+        n_Delete(&n, type == SINGTYPE_BIGINT ? coeffs_BIGINT : r->cf);
+    }
+}
+
+static bool GetOperands(Obj a, Obj b, Operands &ops)
+{
+    ops.tmpx = ops.tmpy = false;
+    if (TNUM_OBJ(a) == T_SINGULAR && TNUM_OBJ(b) == T_SINGULAR) {
+        ops.type = TYPE_SINGOBJ(a) & ~1;
+        if (ops.type != (TYPE_SINGOBJ(b) & ~1))
+            return false;
+        ops.r = 0;
+        if (HasRingTable[ops.type]) {
+            ops.r = CXXRING_SINGOBJ(a);
+            if (ops.r != CXXRING_SINGOBJ(b))
+                return false;
+        }
+        ops.x = CXX_SINGOBJ(a);
+        ops.y = CXX_SINGOBJ(b);
+        return true;
+    }
+    Obj s = (TNUM_OBJ(a) == T_SINGULAR) ? a : b;
+    Obj i = (s == a) ? b : a;
+    if (!IS_INTOBJ(i))
+        return false;
+    ops.type = TYPE_SINGOBJ(s) & ~1;
+    ops.r = HasRingTable[ops.type] ? CXXRING_SINGOBJ(s) : 0;
+    void *conv;
+    if (!IntToSing(i, ops.type, ops.r, &conv))
+        return false;
+    if (s == a) {
+        ops.x = CXX_SINGOBJ(s);
+        ops.y = conv;
+        ops.tmpy = true;
+    } else {
+        ops.x = conv;
+        ops.y = CXX_SINGOBJ(s);
+        ops.tmpx = true;
+    }
+    return true;
+}
+
+// Largest exponent of any variable in p.
+static long MaxExp(poly p, ring r)
+{
+    long max = 0;
+    for (; p != NULL; pIter(p))
+        for (int i = 1; i <= rVar(r); i++)
+            if (p_GetExp(p, i, r) > max)
+                max = p_GetExp(p, i, r);
+    return max;
+}
+
+// Largest exponent of any variable in the n polys m[0], ..., m[n-1],
+// e.g. the entries of an ideal or matrix.
+static long MaxExp(poly *m, int n, ring r)
+{
+    long max = 0;
+    for (int i = 0; i < n; i++) {
+        long e = MaxExp(m[i], r);
+        if (e > max)
+            max = e;
+    }
+    return max;
+}
+
+// Compute x op y for the operands, see GetOperands. Returns false if
+// this is not supported here.
+static bool BinaryOp(int op, const Operands &ops, void **res)
+{
+    ring r = ops.r;
+    const coeffs cf = (ops.type == SINGTYPE_BIGINT) ? coeffs_BIGINT
+                      : r ? r->cf : NULL;
+    if (r && r->qideal != NULL && ops.type != SINGTYPE_NUMBER)
+        return false;
+    switch (ops.type) {
+        case SINGTYPE_POLY:
+        case SINGTYPE_VECTOR: {
+            poly x = (poly)ops.x, y = (poly)ops.y;
+            if (op == OP_SUM)
+                *res = p_Add_q(p_Copy(x, r), p_Copy(y, r), r);
+            else if (op == OP_DIFF)
+                *res = p_Sub(p_Copy(x, r), p_Copy(y, r), r);
+            else if (op == OP_PROD && ops.type == SINGTYPE_POLY) {
+                // Leave exponent overflows to the interpreter, which
+                // reports them.
+                if ((unsigned long)(MaxExp(x, r) + MaxExp(y, r)) > r->bitmask)
+                    return false;
+                *res = pp_Mult_qq(x, y, r);
+            } else
+                return false;
+            return true;
+        }
+        case SINGTYPE_NUMBER:
+        case SINGTYPE_BIGINT: {
+            number x = (number)ops.x, y = (number)ops.y, n;
+            if (op == OP_SUM)
+                n = n_Add(x, y, cf);
+            else if (op == OP_DIFF)
+                n = n_Sub(x, y, cf);
+            else if (op == OP_PROD)
+                n = n_Mult(x, y, cf);
+            else if (op == OP_QUO && ops.type == SINGTYPE_NUMBER &&
+                     !n_IsZero(y, cf))
+                n = n_Div(x, y, cf);
+            else
+                return false;
+            n_Normalize(n, cf);
+            *res = n;
+            return true;
+        }
+        case SINGTYPE_MATRIX: {
+            matrix x = (matrix)ops.x, y = (matrix)ops.y, m;
+            if (op == OP_SUM)
+                m = mp_Add(x, y, r);
+            else if (op == OP_DIFF)
+                m = mp_Sub(x, y, r);
+            else if (op == OP_PROD) {
+                // Each entry of the product is a sum of products of
+                // entries, see the poly case.
+                if ((unsigned long)(MaxExp(x->m, MATROWS(x) * MATCOLS(x), r) +
+                                    MaxExp(y->m, MATROWS(y) * MATCOLS(y), r))
+                    > r->bitmask)
+                    return false;
+                m = mp_Mult(x, y, r);
+            } else
+                return false;
+            *res = m;
+            return m != NULL;   // NULL if the sizes do not match
+        }
+        case SINGTYPE_IDEAL: {
+            ideal x = (ideal)ops.x, y = (ideal)ops.y;
+            if (op == OP_SUM)
+                *res = id_Add(x, y, r);
+            else if (op == OP_PROD) {
+                if ((unsigned long)(MaxExp(x->m, IDELEMS(x), r) +
+                                    MaxExp(y->m, IDELEMS(y), r)) > r->bitmask)
+                    return false;
+                *res = id_Mult(x, y, r);
+            } else
+                return false;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Product of a polynomial and a vector, in either order.
+static Obj ProdPolyVector(Obj a, Obj b)
+{
+    if (TNUM_OBJ(a) != T_SINGULAR || TNUM_OBJ(b) != T_SINGULAR)
+        return NULL;
+    UInt ta = TYPE_SINGOBJ(a) & ~1, tb = TYPE_SINGOBJ(b) & ~1;
+    if (!((ta == SINGTYPE_POLY && tb == SINGTYPE_VECTOR) ||
+          (ta == SINGTYPE_VECTOR && tb == SINGTYPE_POLY)))
+        return NULL;
+    ring r = CXXRING_SINGOBJ(a);
+    if (r != CXXRING_SINGOBJ(b) || r->qideal != NULL)
+        return NULL;
+    poly x = (poly)CXX_SINGOBJ(a), y = (poly)CXX_SINGOBJ(b);
+    if ((unsigned long)(MaxExp(x, r) + MaxExp(y, r)) > r->bitmask)
+        return NULL;
+    if (r != currRing) rChangeCurrRing(r);
+    return WrapResult(SINGTYPE_VECTOR, pp_Mult_qq(x, y, r), r,
+                      IsImmutableOperand(a) && IsImmutableOperand(b));
+}
+
+static Obj ArithSingObj(int op, Obj a, Obj b)
+{
+    Operands ops;
+    if (!GetOperands(a, b, ops))
+        return NULL;
+    if (ops.r && ops.r != currRing)
+        rChangeCurrRing(ops.r);
+    void *res;
+    bool ok = BinaryOp(op, ops, &res);
+    if (ops.tmpx)
+        FreeTemp(ops.type, ops.x, ops.r);
+    if (ops.tmpy)
+        FreeTemp(ops.type, ops.y, ops.r);
+    if (!ok)
+        return NULL;
+    return WrapResult(ops.type, res, ops.r,
+                      IsImmutableOperand(a) && IsImmutableOperand(b));
+}
+
+Obj SumSingObj(Obj a, Obj b)
+{
+    Obj res = ArithSingObj(OP_SUM, a, b);
+    return res ? res : SumObject(a, b);
+}
+
+Obj DiffSingObj(Obj a, Obj b)
+{
+    Obj res = ArithSingObj(OP_DIFF, a, b);
+    return res ? res : DiffObject(a, b);
+}
+
+Obj ProdSingObj(Obj a, Obj b)
+{
+    Obj res = ArithSingObj(OP_PROD, a, b);
+    if (!res)
+        res = ProdPolyVector(a, b);
+    return res ? res : ProdObject(a, b);
+}
+
+Obj QuoSingObj(Obj a, Obj b)
+{
+    Obj res = ArithSingObj(OP_QUO, a, b);
+    return res ? res : QuoObject(a, b);
+}
+
+//! Power of a polynomial, number or bigint with a non-negative small
+//! integer exponent.
+Obj PowSingObj(Obj a, Obj b)
+{
+    if (!IS_INTOBJ(b) || INT_INTOBJ(b) < 0 || INT_INTOBJ(b) > INT_MAX)
+        return PowObject(a, b);
+    int e = INT_INTOBJ(b);
+    UInt type = TYPE_SINGOBJ(a) & ~1;
+    ring r = HasRingTable[type] ? CXXRING_SINGOBJ(a) : 0;
+    if (r && r != currRing)
+        rChangeCurrRing(r);
+    void *res;
+    switch (type) {
+        case SINGTYPE_POLY: {
+            poly p = (poly)CXX_SINGOBJ(a);
+            if (r->qideal != NULL)
+                return PowObject(a, b);
+            if (e > 0 && (unsigned long)MaxExp(p, r) > r->bitmask / e)
+                return PowObject(a, b);
+            res = p_Power(p_Copy(p, r), e, r);
+            break;
+        }
+        case SINGTYPE_NUMBER:
+        case SINGTYPE_BIGINT: {
+            const coeffs cf = r ? r->cf : coeffs_BIGINT;
+            number n;
+            n_Power((number)CXX_SINGOBJ(a), e, &n, cf);
+            res = n;
+            break;
+        }
+        default:
+            return PowObject(a, b);
+    }
+    return WrapResult(type, res, r, IsImmutableOperand(a));
+}
+
+//! Additive inverse of a polynomial, vector, number, bigint or matrix,
+//! with the same mutability as the argument.
+Obj AInvSingObj(Obj a)
+{
+    UInt type = TYPE_SINGOBJ(a) & ~1;
+    ring r = HasRingTable[type] ? CXXRING_SINGOBJ(a) : 0;
+    if (r && r != currRing)
+        rChangeCurrRing(r);
+    void *res;
+    switch (type) {
+        case SINGTYPE_POLY:
+        case SINGTYPE_VECTOR:
+            res = p_Neg(p_Copy((poly)CXX_SINGOBJ(a), r), r);
+            break;
+        case SINGTYPE_NUMBER:
+        case SINGTYPE_BIGINT: {
+            const coeffs cf = r ? r->cf : coeffs_BIGINT;
+            res = n_InpNeg(n_Copy((number)CXX_SINGOBJ(a), cf), cf);
+            break;
+        }
+        case SINGTYPE_MATRIX: {
+            matrix m = mp_Copy((matrix)CXX_SINGOBJ(a), r);
+            for (int i = MATROWS(m) * MATCOLS(m) - 1; i >= 0; i--)
+                m->m[i] = p_Neg(m->m[i], r);
+            res = m;
+            break;
+        }
+        default:
+            return AInvObject(a);
+    }
+    return WrapResult(type, res, r, IsImmutableOperand(a));
+}
+
+
+//////////////// In-place arithmetic ////////////////////
+
+// SI_AddInPlace, SI_AddScaledInPlace and SI_MultInPlace modify the
+// payload of a mutable polynomial, vector or matrix, using the
+// destructive Singular kernel functions. Loops that repeatedly update
+// the same object, like row reductions, thus do not allocate a new
+// wrapper and copy the accumulated value in every step.
+
+// Check that a can be modified in place and return its type.
+static UInt InPlaceTarget(Obj a)
+{
+    if (TNUM_OBJ(a) != T_SINGULAR)
+        _SI_ErrorQuit("<a> must be a Singular object", 0L, 0L);
+    UInt type = TYPE_SINGOBJ(a) & ~1;
+    if (type != SINGTYPE_POLY && type != SINGTYPE_VECTOR &&
+        type != SINGTYPE_MATRIX)
+        _SI_ErrorQuit("<a> must be a polynomial, vector or matrix", 0L, 0L);
+    if (!IS_MUTABLE_OBJ(a))
+        _SI_ErrorQuit("<a> must be mutable", 0L, 0L);
+    // The results would have to be reduced modulo the quotient ideal
+    if (CXXRING_SINGOBJ(a)->qideal != NULL)
+        _SI_ErrorQuit("<a> must not be defined over a quotient ring", 0L, 0L);
+    return type;
+}
+
+// Check that b has the given type, ring and, for matrices, the same
+// size as the matrix m.
+static void CheckInPlaceOperand(Obj b, UInt type, ring r, matrix m)
+{
+    if (TNUM_OBJ(b) != T_SINGULAR || (TYPE_SINGOBJ(b) & ~1) != type)
+        _SI_ErrorQuit("<b> must be of the same type as <a>", 0L, 0L);
+    if (CXXRING_SINGOBJ(b) != r)
+        _SI_ErrorQuit("<a> and <b> must be defined over the same ring", 0L, 0L);
+    if (type == SINGTYPE_MATRIX) {
+        matrix mb = (matrix)CXX_SINGOBJ(b);
+        if (MATROWS(mb) != MATROWS(m) || MATCOLS(mb) != MATCOLS(m))
+            _SI_ErrorQuit("<a> and <b> must have the same size", 0L, 0L);
+    }
+}
+
+//! Check that c is a GAP number or a Singular number over r.
+void _SI_CheckScalar(Obj c, ring r)
+{
+    if (TNUM_OBJ(c) == T_SINGULAR &&
+        ((TYPE_SINGOBJ(c) & ~1) != SINGTYPE_NUMBER || CXXRING_SINGOBJ(c) != r))
+        _SI_ErrorQuit("<c> must be a scalar over the ring of <a>", 0L, 0L);
+}
+
+//! Return true if m is a polynomial over r with exactly one term.
+bool _SI_IsMonomial(Obj m, ring r)
+{
+    if (TNUM_OBJ(m) != T_SINGULAR ||
+        (TYPE_SINGOBJ(m) & ~1) != SINGTYPE_POLY || CXXRING_SINGOBJ(m) != r)
+        return false;
+    poly p = (poly)CXX_SINGOBJ(m);
+    return p != NULL && pNext(p) == NULL;
+}
+
+//! Return a new Singular number for the scalar c, see _SI_CheckScalar.
+number _SI_ScalarFromObj(Obj c, ring r)
+{
+    if (TNUM_OBJ(c) == T_SINGULAR)
+        return n_Copy((number)CXX_SINGOBJ(c), r->cf);
+    return _SI_NUMBER_FROM_GAP(r, c);
+}
+
+//! Check that multiplying p by m does not overflow the exponents.
+void _SI_CheckExponents(poly p, poly m, ring r)
+{
+    if ((unsigned long)(MaxExp(p, r) + MaxExp(m, r)) > r->bitmask)
+        _SI_ErrorQuit("exponent bound exceeded", 0L, 0L);
+}
+
+// Store the (possibly moved) payload of a and update its size.
+static void FinishInPlace(Obj a, UInt type, void *data, ring r)
+{
+    SET_CXX_SINGOBJ(a, data);
+    _SI_SetWrapperBytes(a, _SI_QuickByteSize(GAPtoSingType[type], data, r));
+}
+
+// The entries of a poly or vector payload, or of a matrix.
+static inline int NrEntries(UInt type, void *data)
+{
+    if (type != SINGTYPE_MATRIX)
+        return 1;
+    return MATROWS((matrix)data) * MATCOLS((matrix)data);
+}
+
+static inline poly &Entry(UInt type, void *&data, int i)
+{
+    if (type != SINGTYPE_MATRIX)
+        return (poly &)data;
+    return ((matrix)data)->m[i];
+}
+
+//! Replace the mutable polynomial, vector or matrix a by a + b.
+Obj FuncSI_AddInPlace(Obj self, Obj a, Obj b)
+{
+    UInt type = InPlaceTarget(a);
+    ring r = CXXRING_SINGOBJ(a);
+    CheckInPlaceOperand(b, type, r, (matrix)CXX_SINGOBJ(a));
+
+    if (r != currRing)
+        rChangeCurrRing(r);
+    _SI_UnshareSingObj(a);
+    void *x = CXX_SINGOBJ(a);
+    void *y = CXX_SINGOBJ(b);
+    for (int i = NrEntries(type, x) - 1; i >= 0; i--) {
+        poly q = p_Copy(Entry(type, y, i), r);
+        Entry(type, x, i) = p_Add_q(Entry(type, x, i), q, r);
+    }
+    FinishInPlace(a, type, x, r);
+    return 0;
+}
+
+//! Replace the mutable polynomial, vector or matrix a by a + c*m*b, where
+//! c is a scalar and m a monomial.
+Obj FuncSI_AddScaledInPlace(Obj self, Obj a, Obj c, Obj m, Obj b)
+{
+    UInt type = InPlaceTarget(a);
+    ring r = CXXRING_SINGOBJ(a);
+    CheckInPlaceOperand(b, type, r, (matrix)CXX_SINGOBJ(a));
+    _SI_CheckScalar(c, r);
+    if (!_SI_IsMonomial(m, r))
+        _SI_ErrorQuit("<m> must be a monomial over the ring of <a>", 0L, 0L);
+    poly mon = (poly)CXX_SINGOBJ(m);
+    void *y = CXX_SINGOBJ(b);
+    for (int i = NrEntries(type, y) - 1; i >= 0; i--)
+        _SI_CheckExponents(Entry(type, y, i), mon, r);
+
+    if (r != currRing)
+        rChangeCurrRing(r);
+    number n = _SI_ScalarFromObj(c, r);
+    if (n_IsZero(n, r->cf)) {
+        n_Delete(&n, r->cf);
+        return 0;
+    }
+    mon = p_Mult_nn(p_Head(mon, r), n, r);
+    n_Delete(&n, r->cf);
+
+    _SI_UnshareSingObj(a);
+    void *x = CXX_SINGOBJ(a);
+    y = CXX_SINGOBJ(b);
+    for (int i = NrEntries(type, x) - 1; i >= 0; i--) {
+        poly q = Entry(type, y, i);
+        // p_Plus_mm_Mult_qq destroys its first argument, so it must not
+        // also be the last one.
+        if (x == y) {
+            poly t = pp_Mult_mm(q, mon, r);
+            Entry(type, x, i) = p_Add_q(Entry(type, x, i), t, r);
+        } else
+            Entry(type, x, i) = p_Plus_mm_Mult_qq(Entry(type, x, i), mon, q, r);
+    }
+    p_Delete(&mon, r);
+    FinishInPlace(a, type, x, r);
+    return 0;
+}
+
+//! Replace the mutable polynomial, vector or matrix a by c*a, where c is
+//! a scalar or a monomial.
+Obj FuncSI_MultInPlace(Obj self, Obj a, Obj c)
+{
+    UInt type = InPlaceTarget(a);
+    ring r = CXXRING_SINGOBJ(a);
+    void *x = CXX_SINGOBJ(a);
+    poly mon = NULL;
+    if (_SI_IsMonomial(c, r)) {
+        mon = (poly)CXX_SINGOBJ(c);
+        for (int i = NrEntries(type, x) - 1; i >= 0; i--)
+            _SI_CheckExponents(Entry(type, x, i), mon, r);
+    } else
+        _SI_CheckScalar(c, r);
+
+    if (r != currRing)
+        rChangeCurrRing(r);
+    number n = mon ? NULL : _SI_ScalarFromObj(c, r);
+    _SI_UnshareSingObj(a);
+    x = CXX_SINGOBJ(a);
+    for (int i = NrEntries(type, x) - 1; i >= 0; i--) {
+        poly &p = Entry(type, x, i);
+        if (mon)
+            p = p_Mult_mm(p, mon, r);
+        else if (n_IsZero(n, r->cf))
+            p_Delete(&p, r);
+        else
+            p = p_Mult_nn(p, n, r);
+    }
+    if (n)
+        n_Delete(&n, r->cf);
+    FinishInPlace(a, type, x, r);
+    return 0;
+}
@@ -0,0 +1,43 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef LIBSING_ARITH_H
+#define LIBSING_ARITH_H
+
+#include "libsing.h"
+
+Obj SumSingObj(Obj a, Obj b);
+Obj DiffSingObj(Obj a, Obj b);
+Obj ProdSingObj(Obj a, Obj b);
+Obj QuoSingObj(Obj a, Obj b);
+Obj PowSingObj(Obj a, Obj b);
+Obj AInvSingObj(Obj a);
+
+void _SI_CheckScalar(Obj c, ring r);
+bool _SI_IsMonomial(Obj m, ring r);
+number _SI_ScalarFromObj(Obj c, ring r);
+void _SI_CheckExponents(poly p, poly m, ring r);
+
+Obj FuncSI_AddInPlace(Obj self, Obj a, Obj b);
+Obj FuncSI_AddScaledInPlace(Obj self, Obj a, Obj c, Obj m, Obj b);
+Obj FuncSI_MultInPlace(Obj self, Obj a, Obj c);
+
+#endif
@@ -20,9 +20,13 @@
 
 #include "libsing.h"
 #include "singobj.h"
+#include "memory.h"
+#include "cleanup.h"
+#include "memo.h"
 
 #include <assert.h>
 
+#include <string>
 #include <vector>
 
 // The global variable inerror is an internal variable of the Singular
@@ -41,17 +45,90 @@ UInt _SI_LastOutputStringGVar = 0;
 //! This global is used to store the return value of SPrintEnd.
 static char *_SI_LastOutputBuf = NULL;
 
+//! While a Singular call is running, error messages are collected in
+//! this buffer instead of the GAP string in _SI_LastErrorStringGVar.
+//! Thus no GAP objects are allocated during the call, which means no
+//! garbage collection can happen; this is required for arguments which
+//! SingObj references directly inside GAP bags (borrowed mode).
+static char *_SI_ErrorBuf = NULL;
+static size_t _SI_ErrorBufLen = 0;
+static size_t _SI_ErrorBufSize = 0;
+static bool _SI_CapturingErrors = false;
+
 static void ResetString(UInt gvar)
 {
     Obj strObj = VAL_GVAR(gvar);
-    if (IS_STRING(strObj)) {
+    if (IS_STRING(strObj) && GET_LEN_STRING(strObj) > 0) {
         SET_LEN_STRING(strObj, 0);
         CSTR_STRING(strObj)[0] = 0;
         SHRINK_STRING(strObj);
     }
 }
 
-static void StartPrintCapture()
+static void AppendErrorString(const char *st, UInt len)
+{
+    Obj strObj = VAL_GVAR(_SI_LastErrorStringGVar);
+    if (IS_STRING(strObj)) {
+        UInt oldlen = GET_LEN_STRING(strObj);
+        GROW_STRING(strObj, oldlen + len + 2);
+        char *p = CSTR_STRING(strObj);
+        memcpy(p + oldlen, st, len);
+        p[oldlen+len] = '\n';
+        p[oldlen+len+1] = 0;
+        SET_LEN_STRING(strObj, oldlen + len + 1);
+    }
+}
+
+//
+// Output capture modes, see SI_SetOutputCapture:
+// In mode "on", all output is collected via SPrintStart/SPrintEnd.
+// In mode "lazy", output is collected via PrintS_callback into a buffer
+// which is only allocated once something is actually printed.
+// In mode "off", output is discarded via PrintS_callback.
+//
+enum {
+    SI_CAPTURE_OFF,
+    SI_CAPTURE_LAZY,
+    SI_CAPTURE_ON
+};
+
+static int _SI_OutputCaptureMode = SI_CAPTURE_ON;
+static int _SI_ActiveCaptureMode = SI_CAPTURE_ON;
+static bool _SI_CaptureActive = false;
+static void (*_SI_SavedPrintS_callback)(const char *s) = NULL;
+
+static char *_SI_LazyOutputBuf = NULL;
+static size_t _SI_LazyOutputLen = 0;
+static size_t _SI_LazyOutputSize = 0;
+
+static void _SI_LazyPrintS(const char *s)
+{
+    size_t len = strlen(s);
+    if (len == 0)
+        return;
+    size_t needed = _SI_LazyOutputLen + len + 1;
+    if (needed > _SI_LazyOutputSize) {
+        size_t newsize = needed < 256 ? 256 : 2 * needed;
+        if (_SI_LazyOutputBuf)
+            _SI_LazyOutputBuf = (char *)omReallocSize(_SI_LazyOutputBuf,
+                                            _SI_LazyOutputSize, newsize);
+        else
+            _SI_LazyOutputBuf = (char *)omAlloc(newsize);
+        _SI_LazyOutputSize = newsize;
+    }
+    memcpy(_SI_LazyOutputBuf + _SI_LazyOutputLen, s, len + 1);
+    _SI_LazyOutputLen += len;
+}
+
+static void _SI_DiscardPrintS(const char *s)
+{
+}
+
+static void EndPrintCapture();
+
+//! Forget the output of the previous Singular call. This is also used
+//! by calls which return without running Singular, e.g. memoized ones.
+static void ResetLastOutput()
 {
     if (_SI_LastOutputBuf) {
         omFree(_SI_LastOutputBuf);
@@ -59,13 +136,95 @@ static void StartPrintCapture()
     _SI_LastOutputBuf = NULL;
 
     ResetString(_SI_LastOutputStringGVar);
+}
+
+static void StartPrintCapture(int mode)
+{
+    // A capture left by an error raised directly by the GAP kernel
+    if (_SI_CaptureActive)
+        EndPrintCapture();
 
-    SPrintStart();
+    ResetLastOutput();
+
+    _SI_ActiveCaptureMode = mode;
+    _SI_CaptureActive = true;
+    if (mode == SI_CAPTURE_ON) {
+        SPrintStart();
+    } else {
+        // Singular's PrintS hands its output to PrintS_callback if
+        // no SPrint buffer is active.
+        _SI_SavedPrintS_callback = PrintS_callback;
+        if (mode == SI_CAPTURE_LAZY)
+            PrintS_callback = _SI_LazyPrintS;
+        else
+            PrintS_callback = _SI_DiscardPrintS;
+    }
     errorreported = 0;
+    _SI_CapturingErrors = true;
+    _SI_StartMemoryGuard();
+}
+
+static void StartPrintCapture()
+{
+    StartPrintCapture(_SI_OutputCaptureMode);
+}
+
+//! End the print capture, if one is active. This is called by
+//! _SI_ErrorQuit, so that PrintS_callback, the SPrint buffer and the
+//! memory guard are restored before the longjmp back into GAP.
+void _SI_AbortPrintCapture()
+{
+    EndPrintCapture();
 }
 
 static void EndPrintCapture() {
-    _SI_LastOutputBuf = SPrintEnd();
+    if (!_SI_CaptureActive)
+        return;
+    _SI_CaptureActive = false;
+    _SI_StopMemoryGuard();
+    if (_SI_ActiveCaptureMode == SI_CAPTURE_ON) {
+        _SI_LastOutputBuf = SPrintEnd();
+    } else {
+        PrintS_callback = _SI_SavedPrintS_callback;
+        // In lazy mode, this is NULL if nothing was printed
+        _SI_LastOutputBuf = _SI_LazyOutputBuf;
+        _SI_LazyOutputBuf = NULL;
+        _SI_LazyOutputLen = 0;
+        _SI_LazyOutputSize = 0;
+    }
+    _SI_CapturingErrors = false;
+    if (_SI_ErrorBufLen > 0) {
+        // From here on, allocating GAP objects is fine again.
+        _SI_ErrorBufLen = 0;
+        AppendErrorString(_SI_ErrorBuf, strlen(_SI_ErrorBuf));
+    }
+}
+
+/// The value returned when a Singular call failed: usually fail, but
+/// SI_MemoryLimitExceeded if it was aborted because of the memory limit.
+static Obj CallFailure()
+{
+    return _SI_MemoryLimitHit() ? SI_MemoryLimitExceeded : Fail;
+}
+
+/// Set the output capture mode for calls into Singular to one of
+/// "on" (the default), "lazy" or "off".
+Obj FuncSI_SetOutputCapture(Obj self, Obj mode)
+{
+    if (!IsStringConv(mode)) {
+        _SI_ErrorQuit("mode must be a string", 0L, 0L);
+        return Fail;
+    }
+    const char *st = (const char *)CHARS_STRING(mode);
+    if (strcmp(st, "on") == 0)
+        _SI_OutputCaptureMode = SI_CAPTURE_ON;
+    else if (strcmp(st, "lazy") == 0)
+        _SI_OutputCaptureMode = SI_CAPTURE_LAZY;
+    else if (strcmp(st, "off") == 0)
+        _SI_OutputCaptureMode = SI_CAPTURE_OFF;
+    else
+        _SI_ErrorQuit("mode must be one of \"on\", \"lazy\" or \"off\"", 0L, 0L);
+    return 0;
 }
 
 Obj FuncSingularLastOutput(Obj self)
@@ -84,17 +243,55 @@ Obj FuncSingularLastOutput(Obj self)
 
 void _SI_ErrorCallback(const char *st)
 {
-    Obj strObj = VAL_GVAR(_SI_LastErrorStringGVar);
-    if (IS_STRING(strObj)) {
-        UInt len = (UInt)strlen(st);
-        UInt oldlen = GET_LEN_STRING(strObj);
-        GROW_STRING(strObj, oldlen + len + 2);
-        char *p = CSTR_STRING(strObj);
-        memcpy(p + oldlen, st, len);
-        p[oldlen+len] = '\n';
-        p[oldlen+len+1] = 0;
-        SET_LEN_STRING(strObj, oldlen + len + 1);
+    UInt len = (UInt)strlen(st);
+    if (!_SI_CapturingErrors) {
+        AppendErrorString(st, len);
+        return;
     }
+    // Messages are separated by newlines; the last one gets its newline
+    // from AppendErrorString.
+    size_t needed = _SI_ErrorBufLen + len + 2;
+    if (needed > _SI_ErrorBufSize) {
+        size_t newsize = needed < 256 ? 256 : 2 * needed;
+        _SI_ErrorBuf = (char *)realloc(_SI_ErrorBuf, newsize);
+        _SI_ErrorBufSize = newsize;
+    }
+    if (_SI_ErrorBufLen > 0)
+        _SI_ErrorBuf[_SI_ErrorBufLen++] = '\n';
+    memcpy(_SI_ErrorBuf + _SI_ErrorBufLen, st, len);
+    _SI_ErrorBufLen += len;
+    _SI_ErrorBuf[_SI_ErrorBufLen] = 0;
+}
+
+/// The interpreter expects currRingHdl to be a handle for currRing.
+/// If it is not, point it at the handle cached in the wrapper of
+/// currRing. Only if currRing is not wrapped, a temporary handle is
+/// created, which is returned in tmpHdl and must be released by
+/// RestoreCurrRingHdl. Returns true if currRingHdl was changed.
+static bool SetCurrRingHdl(idhdl &tmpHdl)
+{
+    tmpHdl = 0;
+    if (!currRing || (currRingHdl && IDRING(currRingHdl) == currRing))
+        return false;
+
+    currRingHdl = _SI_RingHdl(currRing);
+    if (currRingHdl == 0) {
+        tmpHdl = enterid(" libsing fake currRingHdl ", 0, RING_CMD, &IDROOT, FALSE, FALSE);
+        assert(tmpHdl);
+        IDRING(tmpHdl) = currRing;
+        currRing->ref++;
+
+        currRingHdl = tmpHdl;
+    }
+    return true;
+}
+
+static void RestoreCurrRingHdl(bool changed, idhdl tmpHdl)
+{
+    if (tmpHdl)
+        killhdl(tmpHdl, currPack);
+    if (changed)
+        currRingHdl = 0;
 }
 
 ///! Send a string to the Singular interpreter, which is then evaluated.                   
@@ -112,19 +309,15 @@ Obj Func_SI_EVALUATE(Obj self, Obj st)
 
     ResetString(_SI_LastErrorStringGVar);
 
-    idhdl tmpHdl = 0;
-    // TODO: resolve code duplication between Func_SI_EVALUATE and FuncSI_CallProc
-    if (currRing && (!currRingHdl || IDRING(currRingHdl) != currRing)) {
-        // TODO: Perhaps we should be using getSingularIdhdl() here, too?
-        tmpHdl = enterid(" libsing fake currRingHdl ", 0, RING_CMD, &IDROOT, FALSE, FALSE);
-        assert(tmpHdl);
-        IDRING(tmpHdl) = currRing;
-        currRing->ref++;
+    // The code may kill or redefine procs.
+    _SI_InvalidateProcHandles();
 
-        currRingHdl = tmpHdl;
-    }
+    idhdl tmpHdl;
+    bool changedHdl = SetCurrRingHdl(tmpHdl);
 
-    StartPrintCapture();
+    // Output of code evaluated explicitly is always captured, as
+    // Singular() shows it to the user.
+    StartPrintCapture(SI_CAPTURE_ON);
     myynest = 1;
     BOOLEAN err = iiAllStart(NULL, ost, BT_proc, 0);
     inerror = 0;
@@ -132,21 +325,42 @@ Obj Func_SI_EVALUATE(Obj self, Obj st)
 
     omFree(ost);
 
-    if (tmpHdl) {
-        killhdl(tmpHdl, currPack);
-        currRingHdl = 0;
-    }
+    RestoreCurrRingHdl(changedHdl, tmpHdl);
 
+    if (_SI_MemoryLimitHit())
+        return SI_MemoryLimitExceeded;
     return err ? False : True;
 }
 
+/// Returns true if the data and attributes of obj belong to obj itself,
+/// and not to an interpreter identifier (or a subexpression of one).
+/// In that case, they can be taken over instead of being copied.
+static inline bool OwnsData(sleftv &obj)
+{
+    return obj.rtyp != IDHDL && obj.rtyp != ALIAS_CMD && obj.e == NULL;
+}
+
+/// Take over the attributes of obj, copying them only if they are
+/// still referenced from elsewhere.
+static attr AdoptAttributes(sleftv &obj)
+{
+    if (OwnsData(obj)) {
+        attr a = obj.attribute;
+        obj.attribute = NULL;
+        return a;
+    }
+    return obj.CopyA();
+}
+
 /// Wrap the content of a Singular interpreter object in a GAP object.
+/// If obj owns its data (the usual case for results of interpreter
+/// calls), the data is moved into the new wrapper without copying.
 static Obj gapwrap(sleftv &obj, ring r)
 {
     if (r == 0 && obj.RingDependend()) {
         if (currRing == 0) {
             obj.CleanUp();
-            ErrorQuit("Result is ring dependent but can't figure out what the ring should be", 0L, 0L);
+            _SI_ErrorQuit("Result is ring dependent but can't figure out what the ring should be", 0L, 0L);
         }
         if (currRing->ext_ref == 0) {
             currRing->ref++;
@@ -169,7 +383,7 @@ static Obj gapwrap(sleftv &obj, ring r)
     int gtype = SingtoGAPType[typ];
     if (typ != NONE && (gtype <= 0 || gtype > SINGTYPE_LASTNUMBER)) {
         obj.CleanUp();
-        ErrorQuit("gapwrap: unexpected singular object type %d\n", typ, 0L);
+        _SI_ErrorQuit("gapwrap: unexpected singular object type %d\n", typ, 0L);
     }
     
     // Adjust gtype for mutable / immutable: objects which are not copyable
@@ -185,22 +399,32 @@ static Obj gapwrap(sleftv &obj, ring r)
             res = ObjInt_Int((long)obj.Data());
             obj.CleanUp();
             return res;
-        case RING_CMD:
-        case QRING_CMD:
-            res = NEW_SINGOBJ_ZERO_ONE(gtype, (ring)obj.CopyD(), NULL, NULL);
-            break;
-        default:
-            if (HasRingTable[gtype])
-                res = NEW_SINGOBJ_RING(gtype, obj.CopyD(), r);
-            else
-                res = NEW_SINGOBJ(gtype, obj.CopyD());
-            break;
     }
-        
-    if (obj.flag)
-        SET_FLAGS_SINGOBJ(res, obj.flag);
+
+    // Detach data and attributes from obj *before* allocating the
+    // wrapper. sleftv::CopyD() steals the data if obj owns it, and
+    // only copies it if it belongs to an interpreter identifier.
+    attr a = NULL;
     if (obj.attribute != NULL || obj.e != NULL)
-        SET_ATTRIB_SINGOBJ(res, (void *)obj.CopyA());
+        a = AdoptAttributes(obj);
+    BITSET flag = obj.flag;
+    void *data = obj.CopyD();
+
+    if (typ == RING_CMD || typ == QRING_CMD)
+        res = NEW_SINGOBJ_ZERO_ONE(gtype, (ring)data, NULL, NULL);
+    else if (HasRingTable[gtype])
+        res = NEW_SINGOBJ_RING(gtype, data, r);
+    else
+        res = NEW_SINGOBJ(gtype, data);
+
+    // Release whatever is left of obj (e.g. a subexpression); the data
+    // itself is no longer referenced by it.
+    obj.CleanUp(r);
+
+    if (flag)
+        SET_FLAGS_SINGOBJ(res, flag);
+    if (a != NULL)
+        SET_ATTRIB_SINGOBJ(res, (void *)a);
     return res;
 }
 
@@ -243,7 +467,10 @@ public:
     void init(int i, Obj input, ring &extr) {
         assert(h == 0);
 
-        SingObj::init(input, extr);
+        // The Singular interpreter never modifies the data referenced
+        // by our parameter handles, so we can borrow big integers and
+        // strings from GAP instead of copying them.
+        SingObj::init(input, extr, true);
         if (error)
             return;
         
@@ -306,65 +533,379 @@ static ring extractRing(Obj ringOrZero)
 // function arguments are wrapped by some Singular interpreter data
 // structure.
 
+//
+// Direct dispatch for frequently used unary operations.
+//
+// The Singular interpreter looks up the jj* function for an operation
+// and its argument types in its dArith1 table on every call. We cannot
+// call those functions ourselves, as neither the table nor the functions
+// are exported from libSingular. Instead, we reimplement a few cheap
+// but heavily used operations here, for the exact Singular argument
+// types they are defined for; everything else (including any argument
+// which requires a type conversion) still goes through iiExprArith1.
+//
+
+typedef Obj (*FastFunc1)(Obj a);
+
+static Obj FastDegPoly(Obj a)
+{
+    poly p = (poly)CXX_SINGOBJ(a);
+    ring r = CXXRING_SINGOBJ(a);
+    if (p == NULL)
+        return INTOBJ_INT(-1);
+    int dummy;
+    return ObjInt_Int(r->pLDeg(p, &dummy, r));
+}
+
+static Obj FastLeadcoefPoly(Obj a)
+{
+    poly p = (poly)CXX_SINGOBJ(a);
+    ring r = CXXRING_SINGOBJ(a);
+    sleftv result;
+    result.Init();
+    result.rtyp = NUMBER_CMD;
+    if (p == NULL)
+        result.data = n_Init(0, r->cf);
+    else {
+        // Like jjLEADCOEF; normalizing does not change the value, so
+        // this is fine for shared or immutable polys, too.
+        n_Normalize(pGetCoeff(p), r->cf);
+        result.data = n_Copy(pGetCoeff(p), r->cf);
+    }
+    return gapwrap(result, r);
+}
+
+static Obj FastLeadPoly(Obj a)
+{
+    poly p = (poly)CXX_SINGOBJ(a);
+    ring r = CXXRING_SINGOBJ(a);
+    sleftv result;
+    result.Init();
+    result.rtyp = GAPtoSingType[TYPE_SINGOBJ(a)];
+    result.data = p_Head(p, r);
+    return gapwrap(result, r);
+}
+
+static Obj FastSizePoly(Obj a)
+{
+    return ObjInt_Int(pLength((poly)CXX_SINGOBJ(a)));
+}
+
+static Obj FastNrowsMatrix(Obj a)
+{
+    // for matrices, this is the same as MATROWS
+    return ObjInt_Int(((ideal)CXX_SINGOBJ(a))->rank);
+}
+
+static Obj FastNrowsVector(Obj a)
+{
+    return ObjInt_Int(p_MaxComp((poly)CXX_SINGOBJ(a), CXXRING_SINGOBJ(a)));
+}
+
+static Obj FastNcolsMatrix(Obj a)
+{
+    // for modules, this is the same as IDELEMS
+    return ObjInt_Int(MATCOLS((matrix)CXX_SINGOBJ(a)));
+}
+
+static Obj FastNrowsIntvec(Obj a)
+{
+    return ObjInt_Int(((intvec *)CXX_SINGOBJ(a))->rows());
+}
+
+static Obj FastNcolsIntvec(Obj a)
+{
+    return ObjInt_Int(((intvec *)CXX_SINGOBJ(a))->cols());
+}
+
+static const struct {
+    int op;
+    int argtype;    // exact Singular type of the argument
+    FastFunc1 func;
+} FastFunc1Table[] = {
+    { DEG_CMD,      POLY_CMD,    FastDegPoly },
+    { DEG_CMD,      VECTOR_CMD,  FastDegPoly },
+    { LEADCOEF_CMD, POLY_CMD,    FastLeadcoefPoly },
+    { LEADCOEF_CMD, VECTOR_CMD,  FastLeadcoefPoly },
+    { LEAD_CMD,     POLY_CMD,    FastLeadPoly },
+    { LEAD_CMD,     VECTOR_CMD,  FastLeadPoly },
+    { COUNT_CMD,    POLY_CMD,    FastSizePoly },
+    { COUNT_CMD,    VECTOR_CMD,  FastSizePoly },
+    { ROWS_CMD,     MATRIX_CMD,  FastNrowsMatrix },
+    { ROWS_CMD,     MODUL_CMD,   FastNrowsMatrix },
+    { ROWS_CMD,     VECTOR_CMD,  FastNrowsVector },
+    { ROWS_CMD,     INTVEC_CMD,  FastNrowsIntvec },
+    { ROWS_CMD,     INTMAT_CMD,  FastNrowsIntvec },
+    { COLS_CMD,     MATRIX_CMD,  FastNcolsMatrix },
+    { COLS_CMD,     MODUL_CMD,   FastNcolsMatrix },
+    { COLS_CMD,     IDEAL_CMD,   FastNcolsMatrix },
+    { COLS_CMD,     INTVEC_CMD,  FastNcolsIntvec },
+    { COLS_CMD,     INTMAT_CMD,  FastNcolsIntvec },
+};
+
+/// Look up a direct implementation of the unary operation op for
+/// the GAP object a. Returns NULL if there is none.
+static FastFunc1 LookupFastFunc1(int op, Obj a)
+{
+    if (TNUM_OBJ(a) != T_SINGULAR)
+        return NULL;
+    int argtype = GAPtoSingType[TYPE_SINGOBJ(a)];
+    for (UInt i = 0; i < sizeof(FastFunc1Table) / sizeof(FastFunc1Table[0]); i++) {
+        if (FastFunc1Table[i].op == op && FastFunc1Table[i].argtype == argtype)
+            return FastFunc1Table[i].func;
+    }
+    return NULL;
+}
+
+/// Invalidate the proc handles if the operation op may run interpreter
+/// code, which can kill or redefine procs: this is the case for execute
+/// and load, and for any operation that gets a proc as an argument.
+static void NoteUserCode(int op, int nrargs, Obj *args)
+{
+    bool user = (op == EXECUTE_CMD || op == LOAD_CMD);
+    for (int i = 0; i < nrargs && !user; i++)
+        user = TNUM_OBJ(args[i]) == T_SINGULAR &&
+               (TYPE_SINGOBJ(args[i]) & ~1) == SINGTYPE_PROC;
+    if (user)
+        _SI_InvalidateProcHandles();
+}
+
+// Computing Groebner bases, dimensions or Hilbert series is expensive,
+// and the same ideal is often passed to these functions repeatedly. So
+// for immutable ideals and modules, the results are cached in a plain
+// list in the wrapper, see CACHE_SINGOBJ. As neither the object nor its
+// ring (and thus the monomial ordering) can change, only a change of the
+// Singular options can make a cache entry invalid. So the options at the
+// time the entries were stored are kept in the list, too; if they differ
+// from the current options, the cache is ignored, and replaced by the
+// next store. This includes the option redSB, so a cached Groebner basis
+// is reduced exactly if a freshly computed one would be. A result of std
+// is only cached if it carries the isSB flag, i.e. is a complete
+// standard basis.
+
+enum {
+    CACHE_STD = 1,
+    CACHE_DIM,
+    CACHE_MULT,
+    CACHE_VDIM,
+    CACHE_HILB1,    // hilb(I, 1), the first Hilbert series
+    CACHE_HILB2,    // hilb(I, 2), the second Hilbert series
+    CACHE_NRSLOTS = CACHE_HILB2,
+    CACHE_OPTIONS   // a string holding the SingularOptions of the entries
+};
+
+/// Return the cache of a, or NULL if it has none which is valid for the
+/// current options.
+static Obj ValidCache(Obj a)
+{
+    Obj cache = CACHE_SINGOBJ(a);
+    if (cache == NULL)
+        return NULL;
+    const SingularOptions *opts =
+        (const SingularOptions *)CHARS_STRING(ELM_PLIST(cache, CACHE_OPTIONS));
+    return opts->current() ? cache : NULL;
+}
+
+/// Return the cache slot for the result of op applied to the given
+/// arguments, or 0 if the result is not cached.
+static int CacheSlot(int op, int nrargs, Obj *args)
+{
+    Obj a = args[0];
+    if (TNUM_OBJ(a) != T_SINGULAR)
+        return 0;
+    UInt gtype = TYPE_SINGOBJ(a);
+    if (gtype != SINGTYPE_IDEAL_IMM && gtype != SINGTYPE_MODULE_IMM)
+        return 0;
+    if (nrargs == 1) {
+        switch (op) {
+            case STD_CMD:           return CACHE_STD;
+            case DIM_CMD:           return CACHE_DIM;
+            case MULTIPLICITY_CMD:  return CACHE_MULT;
+            case VDIM_CMD:          return CACHE_VDIM;
+        }
+    } else if (nrargs == 2 && op == HILBERT_CMD) {
+        if (args[1] == INTOBJ_INT(1))
+            return CACHE_HILB1;
+        if (args[1] == INTOBJ_INT(2))
+            return CACHE_HILB2;
+    }
+    return 0;
+}
+
+/// Look up a cached result. Returns NULL if there is none. Cached
+/// Singular objects are immutable; like a freshly computed result, the
+/// returned object is a mutable (shallow) copy of it.
+static Obj LookupCache(Obj a, int slot)
+{
+    Obj cache = ValidCache(a);
+    if (cache == NULL || ELM_PLIST(cache, slot) == 0)
+        return NULL;
+    ring r = CXXRING_SINGOBJ(a);
+    if (r != currRing) rChangeCurrRing(r);
+    Obj res = ELM_PLIST(cache, slot);
+    if (TNUM_OBJ(res) == T_SINGULAR)
+        res = ShallowCopyObjSingular(res);
+    return res;
+}
+
+/// Store a result in the cache of a.
+static void StoreCache(Obj a, int slot, Obj res)
+{
+    if (res == Fail || res == SI_MemoryLimitExceeded)
+        return;
+    if (slot == CACHE_STD && (TNUM_OBJ(res) != T_SINGULAR ||
+                              !(FLAGS_SINGOBJ(res) & Sy_bit(FLAG_STD))))
+        return;
+    if (TNUM_OBJ(res) == T_SINGULAR)
+        res = CopyObjSingular(res, 0);
+    Obj cache = ValidCache(a);
+    if (cache == NULL) {
+        Obj opts = NEW_STRING(sizeof(SingularOptions));
+        ((SingularOptions *)CHARS_STRING(opts))->get();
+        cache = NEW_PLIST(T_PLIST, CACHE_OPTIONS);
+        SET_LEN_PLIST(cache, CACHE_OPTIONS);
+        SET_ELM_PLIST(cache, CACHE_OPTIONS, opts);
+        CHANGED_BAG(cache);
+        SET_CACHE_SINGOBJ(a, cache);
+    }
+    SET_ELM_PLIST(cache, slot, res);
+    CHANGED_BAG(cache);
+}
+
 Obj Func_SI_CallFunc1(Obj self, Obj ringOrZero, Obj op, Obj a)
 {
+    NoteUserCode(INT_INTOBJ(op), 1, &a);
+
+    int slot = CacheSlot(INT_INTOBJ(op), 1, &a);
+    if (slot) {
+        Obj res = LookupCache(a, slot);
+        if (res) {
+            ResetLastOutput();
+            return res;
+        }
+    }
+
+    FastFunc1 fast = LookupFastFunc1(INT_INTOBJ(op), a);
+    if (fast) {
+        // Keep the side effect of the interpreter path on currRing.
+        if (HasRingTable[TYPE_SINGOBJ(a)]) {
+            ring r = CXXRING_SINGOBJ(a);
+            if (r != currRing) rChangeCurrRing(r);
+        }
+        // The fast functions print nothing
+        ResetLastOutput();
+        return fast(a);
+    }
+
     ring r = extractRing(ringOrZero);
 
+    UInt hash;
+    bool memo = _SI_MemoKey(op, r, 1, &a, &hash);
+    if (memo) {
+        Obj res = _SI_MemoLookup(op, r, 1, &a, hash);
+        if (res) {
+            ResetLastOutput();
+            return res;
+        }
+    }
+
+    CleanupScope scope;
     SingularIdHdlWithWrap sing(0, a, r);
-    if (sing.error) { ErrorQuit(sing.error, 0L, 0L); }
+    _SI_AddCleanupObject(&sing);
+    if (sing.error) { _SI_ErrorQuit(sing.error, 0L, 0L); }
 
     StartPrintCapture();
     sleftv result;
     BOOLEAN ret = iiExprArith1(&result, sing.ptr(), INT_INTOBJ(op));
     EndPrintCapture();
-    if (ret) {
+    if (ret || _SI_MemoryLimitHit()) {
         result.CleanUp(r);
-        return Fail;
+        return CallFailure();
     }
 
-    return gapwrap(result, r);
+    Obj res = gapwrap(result, r);
+    if (slot)
+        StoreCache(a, slot, res);
+    if (memo)
+        _SI_MemoStore(op, r, 1, &a, hash, res);
+    return res;
 }
 
 Obj Func_SI_CallFunc2(Obj self, Obj ringOrZero, Obj op, Obj a, Obj b)
 {
+    Obj args[2] = { a, b };
+    NoteUserCode(INT_INTOBJ(op), 2, args);
+    int slot = CacheSlot(INT_INTOBJ(op), 2, args);
+    if (slot) {
+        Obj res = LookupCache(a, slot);
+        if (res) {
+            ResetLastOutput();
+            return res;
+        }
+    }
+
     ring r = extractRing(ringOrZero);
 
+    UInt hash;
+    bool memo = _SI_MemoKey(op, r, 2, args, &hash);
+    if (memo) {
+        Obj res = _SI_MemoLookup(op, r, 2, args, hash);
+        if (res) {
+            ResetLastOutput();
+            return res;
+        }
+    }
+
+    CleanupScope scope;
     SingularIdHdlWithWrap singa(0, a, r);
-    if (singa.error) { ErrorQuit(singa.error, 0L, 0L); }
+    _SI_AddCleanupObject(&singa);
+    if (singa.error) { _SI_ErrorQuit(singa.error, 0L, 0L); }
     SingularIdHdlWithWrap singb(1, b, r);
-    if (singb.error) {
-        singa.cleanup();
-        ErrorQuit(singb.error, 0L, 0L);
-    }
+    _SI_AddCleanupObject(&singb);
+    if (singb.error) { _SI_ErrorQuit(singb.error, 0L, 0L); }
 
     StartPrintCapture();
     sleftv result;
     BOOLEAN ret = iiExprArith2(&result, singa.ptr(), INT_INTOBJ(op), singb.ptr());
     EndPrintCapture();
-    if (ret) {
+    if (ret || _SI_MemoryLimitHit()) {
         result.CleanUp(r);
-        return Fail;
+        return CallFailure();
     }
-    return gapwrap(result, r);
+    Obj res = gapwrap(result, r);
+    if (slot)
+        StoreCache(a, slot, res);
+    if (memo)
+        _SI_MemoStore(op, r, 2, args, hash, res);
+    return res;
 }
 
 Obj Func_SI_CallFunc3(Obj self, Obj ringOrZero, Obj op, Obj a, Obj b, Obj c)
 {
     ring r = extractRing(ringOrZero);
 
+    Obj args[3] = { a, b, c };
+    NoteUserCode(INT_INTOBJ(op), 3, args);
+    UInt hash;
+    bool memo = _SI_MemoKey(op, r, 3, args, &hash);
+    if (memo) {
+        Obj res = _SI_MemoLookup(op, r, 3, args, hash);
+        if (res) {
+            ResetLastOutput();
+            return res;
+        }
+    }
+
+    CleanupScope scope;
     SingularIdHdlWithWrap singa(0, a, r);
-    if (singa.error) { ErrorQuit(singa.error, 0L, 0L); }
+    _SI_AddCleanupObject(&singa);
+    if (singa.error) { _SI_ErrorQuit(singa.error, 0L, 0L); }
     SingularIdHdlWithWrap singb(1, b, r);
-    if (singb.error) {
-        singa.cleanup();
-        ErrorQuit(singb.error, 0L, 0L);
-    }
+    _SI_AddCleanupObject(&singb);
+    if (singb.error) { _SI_ErrorQuit(singb.error, 0L, 0L); }
     SingularIdHdlWithWrap singc(2, c, r);
-    if (singc.error) {
-        singa.cleanup();
-        singb.cleanup();
-        ErrorQuit(singc.error, 0L, 0L);
-    }
+    _SI_AddCleanupObject(&singc);
+    if (singc.error) { _SI_ErrorQuit(singc.error, 0L, 0L); }
 
     StartPrintCapture();
     sleftv result;
@@ -373,11 +914,14 @@ Obj Func_SI_CallFunc3(Obj self, Obj ringOrZero, Obj op, Obj a, Obj b, Obj c)
                                singb.ptr(),
                                singc.ptr());
     EndPrintCapture();
-    if (ret) {
+    if (ret || _SI_MemoryLimitHit()) {
         result.CleanUp(r);
-        return Fail;
+        return CallFailure();
     }
-    return gapwrap(result, r);
+    Obj res = gapwrap(result, r);
+    if (memo)
+        _SI_MemoStore(op, r, 3, args, hash, res);
+    return res;
 }
 
 // This class take a GAP list of objects, put each entry into an idhdl,
@@ -421,7 +965,12 @@ public:
     }
     
     ~WrapMultiArgs() {
+        cleanup();
+    }
+
+    void cleanup() {
         delete [] sing;
+        sing = 0;
     }
 };
 
@@ -430,20 +979,200 @@ Obj Func_SI_CallFuncM(Obj self, Obj ringOrZero, Obj op, Obj arg)
     ring r = extractRing(ringOrZero);
 
     int nrargs = (int)LEN_PLIST(arg);
+    // Copy the arguments, as allocating GAP objects may move the list.
+    std::vector<Obj> args(nrargs);
+    for (int i = 0; i < nrargs; i++)
+        args[i] = ELM_PLIST(arg, i + 1);
+    Obj *argp = nrargs ? &args[0] : NULL;
+    NoteUserCode(INT_INTOBJ(op), nrargs, argp);
+    UInt hash;
+    bool memo = _SI_MemoKey(op, r, nrargs, argp, &hash);
+    if (memo) {
+        Obj res = _SI_MemoLookup(op, r, nrargs, argp, hash);
+        if (res) {
+            ResetLastOutput();
+            return res;
+        }
+    }
+
+    CleanupScope scope;
     WrapMultiArgs wrap(arg, r);
+    _SI_AddCleanupObject(&wrap);
     if (wrap.error)
-        ErrorQuit(wrap.error, 0L, 0L);
+        _SI_ErrorQuit(wrap.error, 0L, 0L);
 
     StartPrintCapture();
     sleftv result;
     BOOLEAN ret = iiExprArithM(&result, nrargs ? &wrap.s_arg : NULL, INT_INTOBJ(op));
     EndPrintCapture();
 
-    if (ret) {
+    if (ret || _SI_MemoryLimitHit()) {
         result.CleanUp(r);
+        return CallFailure();
+    }
+    Obj res = gapwrap(result, r);
+    if (memo)
+        _SI_MemoStore(op, r, nrargs, argp, hash, res);
+    return res;
+}
+
+// A result of Func_SI_CallFuncBatch which still has to be wrapped.
+struct PendingResult {
+    Int pos;        // position in the result list
+    sleftv val;
+    ring r;         // ring argument for gapwrap
+    ring callring;  // currRing after the call
+    int slot;       // cache slot, see CacheSlot
+    Obj arg;        // first argument, for the cache
+};
+
+static void CleanupPendingResults(void *arg, ring)
+{
+    std::vector<PendingResult> &pending = *(std::vector<PendingResult> *)arg;
+    for (UInt k = 0; k < pending.size(); k++) {
+        PendingResult &p = pending[k];
+        p.val.CleanUp(p.r ? p.r : p.callring);
+    }
+    pending.clear();
+}
+
+/// Apply the Singular operation op to each entry of the list tuples,
+/// which must be lists of one to three arguments. Returns the list of
+/// results, where fail indicates that the operation failed for that
+/// particular tuple. Compared to calling _SI_CallFunc1/2/3 once per
+/// tuple, the ring and the print capture are only set up once.
+Obj Func_SI_CallFuncBatch(Obj self, Obj ringOrZero, Obj op, Obj tuples)
+{
+    if (!IS_INTOBJ(op)) {
+        _SI_ErrorQuit("op must be a small integer", 0L, 0L);
         return Fail;
     }
-    return gapwrap(result, r);
+    if (!IS_LIST(tuples)) {
+        _SI_ErrorQuit("tuples must be a list of argument lists", 0L, 0L);
+        return Fail;
+    }
+    Int len = LEN_LIST(tuples);
+    Int i;
+    // Check all tuples first, so that we do not have to abort halfway.
+    for (i = 1; i <= len; i++) {
+        Obj t = ELM_LIST(tuples, i);
+        if (!IS_LIST(t) || LEN_LIST(t) < 1 || LEN_LIST(t) > 3) {
+            _SI_ErrorQuit("each entry of tuples must be a list of 1 to 3 arguments", 0L, 0L);
+            return Fail;
+        }
+    }
+
+    Obj res = NEW_PLIST(T_PLIST, len);
+    SET_LEN_PLIST(res, len);
+
+    int iop = INT_INTOBJ(op);
+    ring extr = extractRing(ringOrZero);
+
+    // Results are wrapped only after the capture ended, as wrapping may
+    // raise an error and allocates GAP objects, which is not allowed
+    // while arguments are borrowed.
+    CleanupScope outer;
+    std::vector<PendingResult> pending;
+    _SI_AddCleanup(CleanupPendingResults, &pending, NULL);
+
+    StartPrintCapture();
+    for (i = 1; i <= len; i++) {
+        Obj t = ELM_LIST(tuples, i);
+        int nrargs = (int)LEN_LIST(t);
+        Obj args[3];
+        int j;
+        // Fetch the arguments before borrowing any of them, as ELM_LIST
+        // might allocate GAP objects.
+        for (j = 0; j < nrargs; j++)
+            args[j] = ELM_LIST(t, j + 1);
+        NoteUserCode(iop, nrargs, args);
+
+        Obj val;
+        int slot = CacheSlot(iop, nrargs, args);
+        if (slot && (val = LookupCache(args[0], slot)) != NULL) {
+            SET_ELM_PLIST(res, i, val);
+            CHANGED_BAG(res);
+            continue;
+        }
+        FastFunc1 fast = (nrargs == 1) ? LookupFastFunc1(iop, args[0]) : NULL;
+        if (fast) {
+            if (HasRingTable[TYPE_SINGOBJ(args[0])]) {
+                ring r = CXXRING_SINGOBJ(args[0]);
+                if (r != currRing) rChangeCurrRing(r);
+            }
+            val = fast(args[0]);
+        } else {
+            ring r = extr;
+            if (r != currRing) rChangeCurrRing(r);
+            CleanupScope scope;
+            SingularIdHdl sing[3];
+            sleftv wrap[3];
+            for (j = 0; j < nrargs; j++) {
+                sing[j].init(j, args[j], r);
+                _SI_AddCleanupObject(&sing[j]);
+                if (sing[j].error)
+                    _SI_ErrorQuit(sing[j].error, 0L, 0L);
+                wrap[j].Init();
+                wrap[j].rtyp = IDHDL;
+                wrap[j].data = sing[j].h;
+            }
+
+            errorreported = 0;
+            sleftv result;
+            BOOLEAN ret;
+            if (nrargs == 1)
+                ret = iiExprArith1(&result, &wrap[0], iop);
+            else if (nrargs == 2)
+                ret = iiExprArith2(&result, &wrap[0], iop, &wrap[1]);
+            else
+                ret = iiExprArith3(&result, iop, &wrap[0], &wrap[1], &wrap[2]);
+            if (ret || _SI_MemoryLimitHit()) {
+                result.CleanUp(r);
+                val = Fail;
+            } else {
+                PendingResult p;
+                p.pos = i;
+                p.val = result;
+                p.r = r;
+                p.callring = currRing;
+                p.slot = slot;
+                p.arg = args[0];
+                pending.push_back(p);
+                val = NULL;
+            }
+        }
+        if (val != NULL) {
+            SET_ELM_PLIST(res, i, val);
+            CHANGED_BAG(res);
+        }
+        if (_SI_MemoryLimitHit())
+            break;
+    }
+    EndPrintCapture();
+
+    for (UInt k = 0; k < pending.size(); k++) {
+        PendingResult &p = pending[k];
+        sleftv result = p.val;
+        p.val.Init();   // now owned by result
+        if (p.callring && p.callring != currRing)
+            rChangeCurrRing(p.callring);
+        Obj val = gapwrap(result, p.r);
+        if (p.slot)
+            StoreCache(p.arg, p.slot, val);
+        SET_ELM_PLIST(res, p.pos, val);
+        CHANGED_BAG(res);
+    }
+    pending.clear();
+
+    // If the memory limit was exceeded, all tuples from the aborted one
+    // on are marked as such.
+    if (_SI_MemoryLimitHit()) {
+        for (; i <= len; i++)
+            SET_ELM_PLIST(res, i, SI_MemoryLimitExceeded);
+        CHANGED_BAG(res);
+    }
+
+    return res;
 }
 
 Obj FuncSI_SetCurrRing(Obj self, Obj rr)
@@ -451,7 +1180,7 @@ Obj FuncSI_SetCurrRing(Obj self, Obj rr)
     if (TNUM_OBJ(rr) != T_SINGULAR ||
         (TYPE_SINGOBJ(rr) != SINGTYPE_RING_IMM &&
          TYPE_SINGOBJ(rr) != SINGTYPE_QRING_IMM)) {
-        ErrorQuit("argument r must be a singular ring", 0L, 0L);
+        _SI_ErrorQuit("argument r must be a singular ring", 0L, 0L);
         return Fail;
     }
     ring r = (ring)CXX_SINGOBJ(rr);
@@ -459,51 +1188,175 @@ Obj FuncSI_SetCurrRing(Obj self, Obj rr)
     return NULL;
 }
 
-Obj FuncSI_CallProc(Obj self, Obj name, Obj args)
+//
+// Proc handles: SI_ProcHandle(name) resolves a Singular proc once and
+// returns a GAP object of type _SI_ProcHandleType, which SI_CallProc
+// accepts instead of the proc name. It contains an index into the table
+// below and the name of the proc. Since procs can be killed or redefined
+// by the interpreter, each table entry records the value of
+// _SI_ProcGeneration at the time it was resolved. The generation is
+// increased whenever interpreter code may have killed or redefined a
+// proc: before evaluating code, loading a library or executing a string
+// (see NoteUserCode), and after a proc call which changed the global
+// identifiers (see IdrootSnapshot). Stale entries are then looked up
+// again by name.
+//
+
+struct ProcCacheEntry {
+    std::string name;
+    idhdl h;
+    UInt generation;
+};
+
+static std::vector<ProcCacheEntry> _SI_ProcCache;
+static UInt _SI_ProcGeneration = 1;
+
+void _SI_InvalidateProcHandles()
+{
+    _SI_ProcGeneration++;
+    // Memoized results of procs are keyed by their name only.
+    _SI_MemoForgetProcs();
+}
+
+// Procs can only be killed or (re)defined by changing the list of
+// global identifiers, which is cheap to compare: redefining a proc
+// enters a new handle at the head, killing one shortens the list.
+// Changes to local identifiers of a proc do not matter, as they are
+// gone when it returns.
+struct IdrootSnapshot {
+    idhdl head;
+    UInt count;
+
+    void take()
+    {
+        head = basePack->idroot;
+        count = 0;
+        for (idhdl h = head; h != NULL; h = IDNEXT(h))
+            count++;
+    }
+
+    bool operator==(const IdrootSnapshot &o) const
+    {
+        return head == o.head && count == o.count;
+    }
+};
+
+/// Return the current proc generation, for testing.
+Obj Func_SI_ProcGeneration(Obj self)
+{
+    return INTOBJ_INT(_SI_ProcGeneration);
+}
+
+/// Installed as SI_ProcHandle helper; returns the table index for the
+/// proc with the given name, or fail if there is no such proc.
+Obj Func_SI_ResolveProc(Obj self, Obj name)
 {
     if (!IsStringConv(name)) {
-        ErrorQuit("First argument must be a string.", 0L, 0L);
+        _SI_ErrorQuit("argument must be a string.", 0L, 0L);
+        return Fail;
+    }
+    const char *st = reinterpret_cast<char*>(CHARS_STRING(name));
+    idhdl h = ggetid(st);
+    if (h == NULL || IDTYP(h) != PROC_CMD)
+        return Fail;
+    UInt i;
+    for (i = 0; i < _SI_ProcCache.size(); i++) {
+        if (_SI_ProcCache[i].name == st)
+            break;
+    }
+    if (i == _SI_ProcCache.size()) {
+        ProcCacheEntry e;
+        e.name = st;
+        _SI_ProcCache.push_back(e);
+    }
+    _SI_ProcCache[i].h = h;
+    _SI_ProcCache[i].generation = _SI_ProcGeneration;
+    return INTOBJ_INT(i);
+}
+
+/// Return the idhdl for a proc handle, looking it up again if the
+/// cached one may be stale. Returns NULL if the proc does not exist.
+static idhdl LookupProcHandle(Obj handle)
+{
+    Obj idx = ELM_PLIST(handle, 1);
+    if (!IS_INTOBJ(idx) || INT_INTOBJ(idx) < 0 ||
+        (UInt)INT_INTOBJ(idx) >= _SI_ProcCache.size())
+        return NULL;
+    ProcCacheEntry &e = _SI_ProcCache[INT_INTOBJ(idx)];
+    if (e.generation != _SI_ProcGeneration) {
+        e.h = ggetid(e.name.c_str());
+        if (e.h != NULL && IDTYP(e.h) != PROC_CMD)
+            e.h = NULL;
+        e.generation = _SI_ProcGeneration;
+    }
+    return e.h;
+}
+
+Obj FuncSI_CallProc(Obj self, Obj name, Obj args)
+{
+    idhdl h;
+    if (TNUM_OBJ(name) == T_POSOBJ && TYPE_OBJ(name) == _SI_ProcHandleType) {
+        h = LookupProcHandle(name);
+        name = ELM_PLIST(name, 2);
+    } else if (IsStringConv(name)) {
+        h = ggetid(reinterpret_cast<char*>(CHARS_STRING(name)));
+    } else {
+        _SI_ErrorQuit("First argument must be a string or a proc handle.", 0L, 0L);
         return Fail;
     }
     if (!IS_LIST(args)) {
-        ErrorQuit("Second argument must be a list.", 0L, 0L);
+        _SI_ErrorQuit("Second argument must be a list.", 0L, 0L);
         return Fail;
     }
 
-    idhdl h = ggetid(reinterpret_cast<char*>(CHARS_STRING(name)));
-    if (h == NULL) {
-        ErrorQuit("Proc %s not found in Singular interpreter.",
+    if (h == NULL || IDTYP(h) != PROC_CMD) {
+        _SI_ErrorQuit("Proc %s not found in Singular interpreter.",
                   (Int)CHARS_STRING(name), 0L);
         return Fail;
     }
 
     ring r = NULL;
-    idhdl tmpHdl = 0;
+    idhdl tmpHdl;
 
     int nrargs = (int)LEN_PLIST(args);
+    CleanupScope scope;
     WrapMultiArgs wrap(args, r);
+    _SI_AddCleanupObject(&wrap);
     if (wrap.error)
-        ErrorQuit(wrap.error, 0L, 0L);
+        _SI_ErrorQuit(wrap.error, 0L, 0L);
 
     if (r)
         rChangeCurrRing(r);
 
-    BOOLEAN bool_ret;
-    // TODO: resolve code duplication between Func_SI_EVALUATE and FuncSI_CallProc
-    if (currRing && (!currRingHdl || IDRING(currRingHdl) != currRing)) {
-        // TODO: Perhaps we should be using getSingularIdhdl() here, too?
-        tmpHdl = enterid(" libsing fake currRingHdl ", 0, RING_CMD, &IDROOT, FALSE, FALSE);
-        assert(tmpHdl);
-        IDRING(tmpHdl) = currRing;
-        currRing->ref++;
-
-        currRingHdl = tmpHdl;
+    // Procedures use the current ring if no argument depends on a ring.
+    ring keyring = currRing;
+    std::vector<Obj> argv(nrargs);
+    for (int i = 0; i < nrargs; i++)
+        argv[i] = ELM_PLIST(args, i + 1);
+    Obj *argp = nrargs ? &argv[0] : NULL;
+    UInt hash;
+    bool memo = _SI_MemoKey(name, keyring, nrargs, argp, &hash);
+    if (memo) {
+        Obj res = _SI_MemoLookup(name, keyring, nrargs, argp, hash);
+        if (res) {
+            ResetLastOutput();
+            return res;
+        }
     }
+
+    BOOLEAN bool_ret;
+    bool changedHdl = SetCurrRingHdl(tmpHdl);
     iiRETURNEXPR.Init();
 
+    // The proc may kill or redefine procs.
+    IdrootSnapshot before, after;
+    before.take();
     StartPrintCapture();
     bool_ret = iiMake_proc(h, NULL, nrargs ? &wrap.s_arg : NULL);
     EndPrintCapture();
+    after.take();
+    if (!(before == after))
+        _SI_InvalidateProcHandles();
 
     inerror = 0;    // reset interpreter error flag
     
@@ -514,6 +1367,9 @@ Obj FuncSI_CallProc(Obj self, Obj name, Obj args)
     Obj retObj;
     if (bool_ret == TRUE) {
         retObj = Fail;
+    } else if (_SI_MemoryLimitHit()) {
+        ret->CleanUp(r);
+        retObj = SI_MemoryLimitExceeded;
     } else if (ret->next != NULL) {
         // TODO: Perhaps merge list handling into gapwrap?
         // so that we can handle lists returned in other places...?
@@ -533,10 +1389,9 @@ Obj FuncSI_CallProc(Obj self, Obj name, Obj args)
         retObj = gapwrap(*ret, r);
     }
 
-    if (tmpHdl) {
-        killhdl(tmpHdl, currPack);
-        currRingHdl = 0;
-    }
+    RestoreCurrRingHdl(changedHdl, tmpHdl);
 
+    if (memo)
+        _SI_MemoStore(name, keyring, nrargs, argp, hash, retObj);
     return retObj;
 }
@@ -0,0 +1,137 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "cleanup.h"
+#include "memory.h"
+
+#include <vector>
+
+struct CleanupEntry {
+    CleanupFunc func;
+    void *arg;
+    ring r;
+};
+
+// The live scopes, innermost last. This is kept here rather than in the
+// CleanupScope objects, as the stack frames of scopes left via a longjmp
+// may already be overwritten when this is noticed.
+struct ScopeInfo {
+    const CleanupScope *scope;
+    UInt mark;      // size of the registry when the scope was created
+    UInt depth;     // GAP recursion depth when the scope was created
+};
+
+static std::vector<CleanupEntry> Registry;
+static std::vector<ScopeInfo> Scopes;
+
+CleanupScope::CleanupScope()
+{
+    // When a scope is created, the current stack frame is the innermost
+    // live one. So any scope located further down the stack (which grows
+    // downwards on all platforms GAP supports) belongs to a function that
+    // was left via a longjmp.
+    while (!Scopes.empty() && (UInt)Scopes.back().scope < (UInt)this) {
+        Registry.resize(Scopes.back().mark);
+        Scopes.pop_back();
+    }
+    ScopeInfo s;
+    s.scope = this;
+    s.mark = Registry.size();
+    s.depth = RecursionDepth;
+    Scopes.push_back(s);
+}
+
+CleanupScope::~CleanupScope()
+{
+    // Scopes further down the stack, which were left via a longjmp, and
+    // this one
+    while (!Scopes.empty() && (UInt)Scopes.back().scope <= (UInt)this) {
+        Registry.resize(Scopes.back().mark);
+        Scopes.pop_back();
+    }
+}
+
+//! Register a temporary: if an error is raised via _SI_ErrorQuit while
+//! the current scope is alive, func(arg, r) is called.
+void _SI_AddCleanup(CleanupFunc func, void *arg, ring r)
+{
+    CleanupEntry e;
+    e.func = func;
+    e.arg = arg;
+    e.r = r;
+    Registry.push_back(e);
+}
+
+//! Forget the most recent registration with the given arg, e.g. because
+//! the temporary was handed over to a GAP wrapper.
+void _SI_RemoveCleanup(void *arg)
+{
+    for (UInt i = Registry.size(); i > 0; i--) {
+        if (Registry[i-1].arg == arg) {
+            Registry.erase(Registry.begin() + (i-1));
+            return;
+        }
+    }
+}
+
+//! Release the temporaries registered by the current kernel call, then
+//! raise a GAP error. Use this instead of ErrorQuit in all kernel
+//! functions.
+void _SI_ErrorQuit(const Char *msg, Int arg1, Int arg2)
+{
+    // Drop scopes left via a longjmp, as the constructor does; then the
+    // scopes of this call are the innermost ones at the current depth.
+    const CleanupScope *here = (const CleanupScope *)&here;
+    while (!Scopes.empty() && (UInt)Scopes.back().scope < (UInt)here) {
+        Registry.resize(Scopes.back().mark);
+        Scopes.pop_back();
+    }
+    UInt mark = Registry.size();
+    while (!Scopes.empty() && Scopes.back().depth == (UInt)RecursionDepth) {
+        mark = Scopes.back().mark;
+        Scopes.pop_back();
+    }
+    // Release in reverse order of registration; as the registry may
+    // be changed by a cleanup function, remove each entry first.
+    while (Registry.size() > mark) {
+        CleanupEntry e = Registry.back();
+        Registry.pop_back();
+        e.func(e.arg, e.r);
+    }
+    // Only now, as it may allocate GAP objects, which is not allowed
+    // while borrowed arguments are alive.
+    _SI_AbortPrintCapture();
+    _SI_StopMemoryGuard();
+    ErrorQuit(msg, arg1, arg2);
+}
+
+//! Cleanup function for a variable of type poly
+void _SI_CleanupPoly(void *arg, ring r)
+{
+    p_Delete((poly *)arg, r);
+}
+
+//! Cleanup function for a variable of type ideal (or matrix)
+void _SI_CleanupIdeal(void *arg, ring r)
+{
+    ideal *id = (ideal *)arg;
+    if (*id != NULL)
+        id_Delete(id, r);
+}
@@ -0,0 +1,110 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LIBSING_CLEANUP_H
+#define LIBSING_CLEANUP_H
+
+#include "libsing.h"
+
+//////////////// Releasing temporaries on errors ////////////////////
+//
+// ErrorQuit does a longjmp back into GAP, so destructors of objects on
+// the stack are not run, and temporaries owned by a kernel function
+// leak. Therefore kernel functions register their temporaries with the
+// cleanup registry, and raise errors via _SI_ErrorQuit, which releases
+// everything registered before calling ErrorQuit.
+//
+// Registrations belong to the innermost CleanupScope. When the scope is
+// left normally, its registrations are simply forgotten: by then, the
+// temporaries have been freed or handed over to a GAP wrapper. A kernel
+// function therefore creates a CleanupScope *before* any object that it
+// registers, so that the scope is destroyed last.
+//
+// Errors raised directly by the GAP kernel (e.g. in ELM_LIST) bypass the
+// registry. Scopes left that way are detected when the next scope is
+// created, and their registrations are dropped without running them, as
+// they may refer to objects in dead stack frames.
+//
+// _SI_ErrorQuit only releases the scopes of the innermost kernel call,
+// that is those created at the current GAP recursion depth. Scopes of a
+// kernel function which ran GAP code (e.g. a list method called by
+// ELM_LIST) are created at a lower depth and are kept: the error may be
+// caught before it reaches that function, which then continues to use
+// its temporaries. If the error does unwind it, its temporaries leak.
+
+typedef void (*CleanupFunc)(void *arg, ring r);
+
+class CleanupScope {
+public:
+    CleanupScope();
+    ~CleanupScope();
+};
+
+void _SI_AddCleanup(CleanupFunc func, void *arg, ring r);
+void _SI_RemoveCleanup(void *arg);
+void _SI_ErrorQuit(const Char *msg, Int arg1, Int arg2);
+
+void _SI_CleanupPoly(void *arg, ring r);
+void _SI_CleanupIdeal(void *arg, ring r);
+
+template <class T>
+void _SI_CleanupDelete(void *arg, ring r)
+{
+    T **p = (T **)arg;
+    delete *p;
+    *p = NULL;
+}
+
+template <class T>
+void _SI_CleanupObject(void *arg, ring r)
+{
+    ((T *)arg)->cleanup();
+}
+
+///! Register the polynomial stored in the variable *p, over the ring r.
+inline void _SI_AddCleanupPoly(poly *p, ring r)
+{
+    _SI_AddCleanup(_SI_CleanupPoly, p, r);
+}
+
+///! Register the ideal, module or matrix stored in the variable *id,
+///! over the ring r.
+inline void _SI_AddCleanupIdeal(ideal *id, ring r)
+{
+    _SI_AddCleanup(_SI_CleanupIdeal, id, r);
+}
+
+///! Register the C++ object stored in the variable *p, which was
+///! allocated with new.
+template <class T>
+inline void _SI_AddCleanupDelete(T **p)
+{
+    _SI_AddCleanup(_SI_CleanupDelete<T>, p, NULL);
+}
+
+///! Register an object with a cleanup() method, like SingObj. The
+///! method must be safe to call more than once.
+template <class T>
+inline void _SI_AddCleanupObject(T *obj)
+{
+    _SI_AddCleanup(_SI_CleanupObject<T>, obj, NULL);
+}
+
+#endif
@@ -19,10 +19,13 @@
  */
 
 #include "libsing.h"
+#include "accumulator.h"
 #include "singobj.h"
 #include "lowlevel_mappings.h"
 #include "matrix.h" // for Func_SI_Matintmat / Func_SI_Matbigintmat
 #include "number.h"
+#include "memory.h"
+#include "cleanup.h"
 
 #include <coeffs/bigintmat.h>
 #include <coeffs/longrat.h>
@@ -30,6 +33,8 @@
 #include <Singular/ipid.h>
 #include <Singular/lists.h>
 
+#include <map>
+
 // The following should be in rational.h but isn't (as of GAP 4.7.2):
 #ifndef NUM_RAT
 #define NUM_RAT(rat)    ADDR_OBJ(rat)[0]
@@ -38,29 +43,6 @@
 
 
 
-/* We add hooks to the wrapper functions to call a garbage collection
-   by GASMAN if more than a threshold of memory is allocated by omalloc  */
-static long gc_omalloc_threshold = 1000000L;
-//static long gcfull_omalloc_threshold = 4000000L;
-
-static int GCCOUNT = 0;
-
-static inline void possiblytriggerGC(void)
-{
-    if ((om_Info.CurrentBytesFromValloc) > gc_omalloc_threshold) {
-        if (GCCOUNT == 10) {
-            GCCOUNT = 0;
-            CollectBags(0, 1);
-        } else {
-            GCCOUNT++;
-            CollectBags(0, 0);
-        }
-        //printf("\nGC: %ld -> ", gc_omalloc_threshold);
-        gc_omalloc_threshold = 2 * om_Info.CurrentBytesFromValloc;
-        //printf("%ld \n", gc_omalloc_threshold); fflush(stdout);
-    }
-}
-
 // get omalloc statistics
 Obj Func_SI_OmPrintInfo( Obj self )
 {
@@ -81,11 +63,13 @@ Obj Func_SI_OmCurrentBytes( Obj self )
 //! \return  a GAP object wrapping the singular object
 Obj NEW_SINGOBJ(UInt type, void *cxx)
 {
-    possiblytriggerGC();
-    Obj tmp = NewBag(T_SINGULAR, 2*sizeof(Obj));
+    UInt bytes = _SI_QuickByteSize(GAPtoSingType[type], cxx, NULL);
+    _SI_NoteNewWrapper(type, NULL, bytes);
+    Obj tmp = NewBag(T_SINGULAR, 3 * sizeof(Obj));
     SET_TYPE_SINGOBJ(tmp, type);
     SET_FLAGS_SINGOBJ(tmp, 0u);
     SET_CXX_SINGOBJ(tmp, cxx);
+    SET_BYTES_SINGOBJ(tmp, bytes);
     return tmp;
 }
 
@@ -97,12 +81,14 @@ Obj NEW_SINGOBJ(UInt type, void *cxx)
 //! \return  a GAP object wrapping the singular object
 Obj NEW_SINGOBJ_RING(UInt type, void *cxx, ring r)
 {
-    possiblytriggerGC();
-    Obj tmp = NewBag(T_SINGULAR, 3 * sizeof(Obj));
+    UInt bytes = _SI_QuickByteSize(GAPtoSingType[type], cxx, r);
+    _SI_NoteNewWrapper(type, r, bytes);
+    Obj tmp = NewBag(T_SINGULAR, 4 * sizeof(Obj));
     SET_TYPE_SINGOBJ(tmp, type);
     SET_FLAGS_SINGOBJ(tmp, 0u);
     SET_CXX_SINGOBJ(tmp, cxx);
     SET_CXXRING_SINGOBJ(tmp, r);
+    SET_BYTES_SINGOBJ(tmp, bytes);
     return tmp;
 }
 
@@ -142,15 +128,18 @@ Obj NEW_SINGOBJ_ZERO_ONE(UInt type, ring r, Obj zero, Obj one)
     // Check if the ring has already been wrapped. In principle, we could
     // then just return ext_ref, 
     if (r->ext_ref != 0) {
-        ErrorQuit("Oops, Singular ring already wrapped again, please report this to SingularInterface team", 0L, 0L);
+        _SI_ErrorQuit("Oops, Singular ring already wrapped again, please report this to SingularInterface team", 0L, 0L);
     }
-    possiblytriggerGC();
-    Obj rr = NewBag(T_SINGULAR, 5 * sizeof(Obj));
+    UInt bytes = _SI_ByteSize(GAPtoSingType[type], r, NULL);
+    _SI_NoteNewWrapper(type, NULL, bytes);
+    Obj rr = NewBag(T_SINGULAR, 7 * sizeof(Obj));
     SET_TYPE_SINGOBJ(rr, type);
     SET_FLAGS_SINGOBJ(rr, 0);
     SET_CXX_SINGOBJ(rr, r);
     SET_ZERO_SINGOBJ(rr, zero);
     SET_ONE_SINGOBJ(rr, one);
+    SET_RINGHDL_SINGOBJ(rr, NULL);
+    SET_BYTES_SINGOBJ(rr, bytes);
     Obj high = makeHighlevelWrapper(rr);
     SET_HIWRAP_SINGOBJ(rr, high);
 
@@ -159,29 +148,74 @@ Obj NEW_SINGOBJ_ZERO_ONE(UInt type, ring r, Obj zero, Obj one)
     return high;
 }
 
+//! Return a Singular interpreter handle referencing the ring r, for use
+//! as currRingHdl. The handle is created on first use and then cached
+//! in the ring wrapper, until the ring is garbage collected.
+//! Returns NULL if r has no GAP wrapper.
+idhdl _SI_RingHdl(ring r)
+{
+    Obj rr = (Obj)r->ext_ref;
+    if (rr == 0)
+        return NULL;
+    idhdl h = RINGHDL_SINGOBJ(rr);
+    if (h == NULL) {
+        char buf[40];
+        // use spaces in variable name to make sure the variable is
+        // never generated on the interpreter level
+        sprintf(buf, " libsing ring %p ", (void *)r);
+        h = enterid(omStrDup(buf), 0, RING_CMD, &(basePack->idroot), FALSE, FALSE);
+        IDRING(h) = r;
+        r->ref++;
+        SET_RINGHDL_SINGOBJ(rr, h);
+    }
+    return h;
+}
+
+//! Release a handle created by _SI_RingHdl.
+static void KillRingHdl(idhdl h)
+{
+    if (currRingHdl == h)
+        currRingHdl = NULL;
+    // Drop the reference held by the handle ourselves, so that
+    // killhdl2 does not try to kill the ring.
+    IDRING(h)->ref--;
+    IDTYP(h) = INT_CMD;
+    IDDATA(h) = 0;
+    killhdl2(h, &(basePack->idroot), NULL);
+}
+
 // The following function is called from the garbage collector, it
-// needs to free the underlying singular object. Since objects are
-// wrapped only once, this is safe. Note in particular that proxy
+// needs to free the underlying singular object (or rather queue it for
+// freeing, see _SI_QueueFree). Since objects are wrapped only once,
+// this is safe. Note in particular that proxy
 // objects do not have TNUM T_SINGULAR and thus are not taking part
 // in this freeing scheme. They do not actually hold a direct
 // reference to a singular object anyway.
 
-static ring *SingularRingsToCleanup = NULL;
+struct RingToCleanup {
+    ring r;
+    idhdl h;    // cached interpreter handle of r, or NULL
+};
+
+static RingToCleanup *SingularRingsToCleanup = NULL;
 static int SRTC_nr = 0;
 static int SRTC_capacity = 0;
 
-static void AddSingularRingToCleanup(ring r)
+static void AddSingularRingToCleanup(ring r, idhdl h)
 {
     if (SingularRingsToCleanup == NULL) {
-        SingularRingsToCleanup = (ring *)malloc(100*sizeof(ring));
+        SingularRingsToCleanup = (RingToCleanup *)malloc(100*sizeof(RingToCleanup));
         SRTC_nr = 0;
         SRTC_capacity = 100;
     } else if (SRTC_nr == SRTC_capacity) {
         SRTC_capacity *= 2;
-        SingularRingsToCleanup = (ring *)realloc(SingularRingsToCleanup,
-                                 SRTC_capacity*sizeof(ring));
+        SingularRingsToCleanup = (RingToCleanup *)realloc(SingularRingsToCleanup,
+                                 SRTC_capacity*sizeof(RingToCleanup));
     }
-    SingularRingsToCleanup[SRTC_nr++] = r;
+    SingularRingsToCleanup[SRTC_nr].r = r;
+    SingularRingsToCleanup[SRTC_nr].h = h;
+    SRTC_nr++;
+    _SI_NoteRingQueued();
 }
 
 static TNumCollectFuncBags oldpostGCfunc = NULL;
@@ -193,10 +227,15 @@ static void SingularRingCleaner(void)
 {
     int i;
     for (i = 0; i < SRTC_nr; i++) {
-        rKill( SingularRingsToCleanup[i] );
+        if (SingularRingsToCleanup[i].h)
+            KillRingHdl(SingularRingsToCleanup[i].h);
+        rKill( SingularRingsToCleanup[i].r );
+        _SI_NoteRingKilled();
         // Pr("killed a ring\n", 0L, 0L);
     }
     SRTC_nr = 0;
+    _SI_NoteCollection();
+    _SI_FreeStep(0);
     oldpostGCfunc();
 }
 
@@ -208,18 +247,68 @@ void InstallPrePostGCFuncs(void)
     InitCollectFuncBags(oldpreGCfunc, SingularRingCleaner);
 }
 
+// Copies of Singular objects share their payload (the C++ object) until
+// one of them is about to be modified, as GAP code often copies objects
+// just to be on the safe side. SharedPayloads maps a shared payload to
+// the number of wrappers referencing it, minus one; payloads referenced
+// by only one wrapper are not in the map. Code that modifies the payload
+// of a mutable wrapper in place must call _SI_UnshareSingObj first.
+//
+// A shared copy is accounted with zero bytes, as it does not own any
+// Singular memory. It gets its real size once it is unshared. When a
+// wrapper with a nonzero size stops referencing a payload which is still
+// shared, its size is parked with the payload and stays in the memory
+// statistics; the last wrapper referencing the payload takes it over
+// (see ReleasePayload).
+
+struct SharedPayload {
+    UInt refs;      // number of wrappers minus one
+    UInt parked;    // bytes left behind by wrappers that stopped sharing
+};
+
+static std::map<void *, SharedPayload> SharedPayloads;
+
+//! Drop one reference to a payload, by a wrapper accounted with *bytes.
+//! Returns false if it is still shared, in which case the caller must
+//! not free it, and *bytes were parked with the payload. Otherwise, the
+//! parked bytes are added to *bytes.
+static bool ReleasePayload(void *data, UInt *bytes)
+{
+    if (data == NULL || SharedPayloads.empty())
+        return true;
+    std::map<void *, SharedPayload>::iterator it = SharedPayloads.find(data);
+    if (it == SharedPayloads.end())
+        return true;
+    SharedPayload &sp = it->second;
+    if (sp.refs == 0) {
+        *bytes += sp.parked;
+        SharedPayloads.erase(it);
+        return true;
+    }
+    sp.refs--;
+    sp.parked += *bytes;
+    if (sp.refs == 0 && sp.parked == 0)
+        SharedPayloads.erase(it);
+    return false;
+}
+
 //! Free a given T_SINGULAR object. It is registered using InitFreeFuncBag
-//!  and GASMAN invokes it as needed.
+//!  and GASMAN invokes it as needed. The Singular object itself is
+//!  only queued for freeing, see _SI_QueueFree.
 void _SI_FreeFunc(Obj o)
 {
-    sleftv obj;
-    obj.Init();
     int gtype = TYPE_SINGOBJ(o);
-    obj.data = CXX_SINGOBJ(o);
-    obj.rtyp = GAPtoSingType[gtype];
-    obj.flag = FLAGS_SINGOBJ(o);
-    obj.attribute = (attr)ATTRIB_SINGOBJ(o);
+    void *data = CXX_SINGOBJ(o);
+    attr a = (attr)ATTRIB_SINGOBJ(o);
     ring r = HasRingTable[gtype] ? CXXRING_SINGOBJ(o) : 0;
+    UInt bytes = BYTES_SINGOBJ(o);
+    if (!ReleasePayload(data, &bytes)) {
+        // another wrapper still references data, and our bytes were
+        // handed over to it
+        data = NULL;
+        bytes = 0;
+    }
+    _SI_NoteFreedWrapper(gtype, r, bytes);
 
     switch (gtype) {
         case SINGTYPE_QRING:
@@ -227,19 +316,29 @@ void _SI_FreeFunc(Obj o)
         case SINGTYPE_RING:
         case SINGTYPE_RING_IMM:
             // Pr("scheduled a ring for killing\n", 0L, 0L);
-            AddSingularRingToCleanup((ring)obj.data);
+            _SI_ForgetRingStats((ring)data);
+            AddSingularRingToCleanup((ring)data, RINGHDL_SINGOBJ(o));
+            break;
+        case SINGTYPE_POLYACC:
+        case SINGTYPE_POLYACC_IMM:
+            if (data != NULL)
+                _SI_FreeAccumulator(data, r, bytes);
             break;
         default:
-            obj.CleanUp(r);
+            if (data != NULL || a != NULL)
+                _SI_QueueFree(GAPtoSingType[gtype], data,
+                              FLAGS_SINGOBJ(o), a, r, bytes);
     }
 }
 
 /// The following function is the marking function for the garbage
-/// collector for T_SINGULAR objects. In the current implementation
-/// this function is not actually needed.
+/// collector for T_SINGULAR objects. It marks the wrapper of the ring
+/// of ring-dependent objects, the zero and one of rings, and the cache
+/// of derived properties, see CACHE_SINGOBJ.
 void _SI_ObjMarkFunc(Bag o)
 {
     Int gtype = TYPE_SINGOBJ(o);
+    MARK_BAG(CACHE_SINGOBJ(o));
     if (HasRingTable[gtype]) {
         ring r = CXXRING_SINGOBJ(o);
         Obj rr = r ? (Obj)r->ext_ref : 0;
@@ -284,17 +383,17 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
 
     // Some checks:
     if (!IS_INTOBJ(charact) || !IS_LIST(names) || !IS_LIST(orderings)) {
-        ErrorQuit("Need immediate integer and two lists", 0L, 0L);
+        _SI_ErrorQuit("Need immediate integer and two lists", 0L, 0L);
         return Fail;
     }
     nrvars = LEN_LIST(names);
     if (nrvars == 0) {
-        ErrorQuit("Need at least one variable name", 0L, 0L);
+        _SI_ErrorQuit("Need at least one variable name", 0L, 0L);
         return Fail;
     }
     for (i = 1; i <= nrvars; i++) {
         if (!IS_STRING_REP(ELM_LIST(names, i))) {
-            ErrorQuit("Variable names must be strings", 0L, 0L);
+            _SI_ErrorQuit("Variable names must be strings", 0L, 0L);
             return Fail;
         }
     }
@@ -306,7 +405,7 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
         Obj tmp = ELM_LIST(orderings, i);
 
         if (!IS_LIST(tmp) || (LEN_LIST(tmp) != 1 && LEN_LIST(tmp) != 2)) {
-            ErrorQuit("Orderings must be lists of length 1 or 2", 0L, 0L);
+            _SI_ErrorQuit("Orderings must be lists of length 1 or 2", 0L, 0L);
             return Fail;
         }
 
@@ -314,13 +413,13 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
         Obj spec = (LEN_LIST(tmp) == 2) ? ELM_LIST(tmp, 2) : 0;
 
         if (!IS_STRING_REP(name)) {
-            ErrorQuit("First entry of ordering must be a string", 0L, 0L);
+            _SI_ErrorQuit("First entry of ordering must be a string", 0L, 0L);
             return Fail;
         }
         
         Int namelen = GET_LEN_STRING(name);
         if (namelen != 1 && namelen != 2) {
-            ErrorQuit("First entry of ordering must be a string of length 1 or 2", 0L, 0L);
+            _SI_ErrorQuit("First entry of ordering must be a string of length 1 or 2", 0L, 0L);
             return Fail;
         }
         
@@ -329,7 +428,7 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
         if (namelen == 1 && nameStr[0] == 'M') {
             // Matrix orderings: "M" must be followed by an intmat (flattened to an intvec of square length)
             if (!IsIntList(spec)) {
-                ErrorQuit("Second entry of ordering of type '%s' must be a plain list of integers", (Int)nameStr, 0L);
+                _SI_ErrorQuit("Second entry of ordering of type '%s' must be a plain list of integers", (Int)nameStr, 0L);
                 return Fail;
             }
             covered += sqrt(LEN_LIST(spec));
@@ -339,7 +438,7 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
             // wp, Wp, ws, Ws must be followed by an int vector
             // Extra weight vector: "a" followed by intvec, can appear anywhere
             if (!IsIntList(spec)) {
-                ErrorQuit("Second entry of ordering of type '%s' must be a plain list of integers", (Int)nameStr, 0L);
+                _SI_ErrorQuit("Second entry of ordering of type '%s' must be a plain list of integers", (Int)nameStr, 0L);
                 return Fail;
             }
             
@@ -353,13 +452,13 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
             // Module ordering: at most once a "c" or "C" followed by nothing may appear.
 #if 0
             if (spec != 0)  {
-                ErrorQuit("Ordering of type '%s' must not be followed by second entry", (Int)nameStr, 0L);
+                _SI_ErrorQuit("Ordering of type '%s' must not be followed by second entry", (Int)nameStr, 0L);
                 return Fail;
             }
 #endif
 
             if (c_ord_is_present) {
-                ErrorQuit("At most one ordering of type 'c' or 'C' may be used", 0L, 0L);
+                _SI_ErrorQuit("At most one ordering of type 'c' or 'C' may be used", 0L, 0L);
                 return Fail;
             }
 
@@ -368,7 +467,7 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
         } else {
             // lp, rp, dp, Dp, ls, rs, ds, Ds may be followed by an int
             if (!spec || !IS_INTOBJ(spec)) {
-                ErrorQuit("Second entry of ordering of type '%s' must be an integer", (Int)nameStr, 0L);
+                _SI_ErrorQuit("Second entry of ordering of type '%s' must be an integer", (Int)nameStr, 0L);
                 return Fail;
             }
 
@@ -376,7 +475,7 @@ Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings)
         }
     }
     if (covered != (int)nrvars) {
-        ErrorQuit("Orderings do not cover exactly the variables", 0L, 0L);
+        _SI_ErrorQuit("Orderings do not cover exactly the variables", 0L, 0L);
         return Fail;
     }
 
@@ -433,12 +532,12 @@ Obj FuncSI_RingOfSingobj( Obj self, Obj singobj )
 {
     singobj = UnwrapHighlevelWrapper(singobj);
     if (TNUM_OBJ(singobj) != T_SINGULAR)
-        ErrorQuit("argument must be singular object.", 0L, 0L);
+        _SI_ErrorQuit("argument must be singular object.", 0L, 0L);
     Int gtype = TYPE_SINGOBJ(singobj);
     if (HasRingTable[gtype]) {
         ring r = CXXRING_SINGOBJ(singobj);
         if (r == 0 || r->ext_ref == 0)
-            ErrorQuit("internal error: bad ring reference in ring dependant object", 0L, 0L);
+            _SI_ErrorQuit("internal error: bad ring reference in ring dependant object", 0L, 0L);
         return (Obj)r->ext_ref;
     } else if (/* gtype == SINGTYPE_RING || */
         gtype == SINGTYPE_RING_IMM ||
@@ -446,7 +545,7 @@ Obj FuncSI_RingOfSingobj( Obj self, Obj singobj )
         gtype == SINGTYPE_QRING_IMM) {
         return singobj;
     } else {
-        ErrorQuit("argument must have associated singular ring.", 0L, 0L);
+        _SI_ErrorQuit("argument must have associated singular ring.", 0L, 0L);
         return Fail;
     }
 }
@@ -458,7 +557,7 @@ Obj FuncSI_Indeterminates(Obj self, Obj rr)
     /* check arg */
     rr = UnwrapHighlevelWrapper(rr);
     if (! ISSINGOBJ(SINGTYPE_RING_IMM, rr))
-        ErrorQuit("argument must be Singular ring.", 0L, 0L);
+        _SI_ErrorQuit("argument must be Singular ring.", 0L, 0L);
 
     ring r = (ring)CXX_SINGOBJ(rr);
     UInt nrvars = rVar(r);
@@ -509,21 +608,22 @@ Obj Func_SI_number(Obj self, Obj rr, Obj nr)
 Obj Func_SI_intvec(Obj self, Obj l)
 {
     if (!IS_LIST(l)) {
-        ErrorQuit("l must be a list", 0L, 0L);
+        _SI_ErrorQuit("l must be a list", 0L, 0L);
         return Fail;
     }
     UInt len = LEN_LIST(l);
     UInt i;
+    CleanupScope scope;
     intvec *iv = new intvec(len);
+    _SI_AddCleanupDelete(&iv);
     for (i = 1; i <= len; i++) {
-        Obj t = ELM_LIST(l, i);
-        if (!IS_INTOBJ(t)
+        Obj t = ELM0_LIST(l, i);
+        if (t == 0 || !IS_INTOBJ(t)
 #ifdef SYS_IS_64_BIT
             || (INT_INTOBJ(t) < -(1L << 31) || INT_INTOBJ(t) >= (1L << 31))
 #endif
            ) {
-            delete iv;
-            ErrorQuit("l must contain small integers", 0L, 0L);
+            _SI_ErrorQuit("l must contain small integers", 0L, 0L);
         }
         (*iv)[i-1] = (int) (INT_INTOBJ(t));
     }
@@ -535,7 +635,7 @@ Obj Func_SI_intvec(Obj self, Obj l)
 Obj Func_SI_Plistintvec(Obj self, Obj iv)
 {
     if (!(ISSINGOBJ(SINGTYPE_INTVEC, iv) || ISSINGOBJ(SINGTYPE_INTVEC_IMM, iv))) {
-        ErrorQuit("iv must be a singular intvec", 0L, 0L);
+        _SI_ErrorQuit("iv must be a singular intvec", 0L, 0L);
         return Fail;
     }
     intvec *i = (intvec *)CXX_SINGOBJ(iv);
@@ -554,34 +654,33 @@ Obj Func_SI_Plistintvec(Obj self, Obj iv)
 Obj Func_SI_ideal_from_els(Obj self, Obj l)
 {
     if (!IS_LIST(l)) {
-        ErrorQuit("l must be a list", 0L, 0L);
+        _SI_ErrorQuit("l must be a list", 0L, 0L);
         return Fail;
     }
     UInt len = LEN_LIST(l);
     if (len == 0) {
-        ErrorQuit("l must contain at least one element", 0L, 0L);
+        _SI_ErrorQuit("l must contain at least one element", 0L, 0L);
         return Fail;
     }
-    ideal id;
+    CleanupScope scope;
+    ideal id = NULL;
     UInt i;
     Obj t = NULL;
     ring r = NULL;
     for (i = 1; i <= len; i++) {
-        t = ELM_LIST(l, i);
-        if (!(ISSINGOBJ(SINGTYPE_POLY, t) || ISSINGOBJ(SINGTYPE_POLY_IMM, t))) {
-            if (i > 1)
-                id_Delete(&id, r);
-            ErrorQuit("l must only contain singular polynomials", 0L, 0L);
+        t = ELM0_LIST(l, i);
+        if (t == 0 || !(ISSINGOBJ(SINGTYPE_POLY, t) || ISSINGOBJ(SINGTYPE_POLY_IMM, t))) {
+            _SI_ErrorQuit("l must only contain singular polynomials", 0L, 0L);
             return Fail;
         }
         if (i == 1) {
             r = CXXRING_SINGOBJ(t);
             if (r != currRing) rChangeCurrRing(r);
             id = idInit(len, 1);
+            _SI_AddCleanupIdeal(&id, r);
         } else {
             if (r != CXXRING_SINGOBJ(t)) {
-                id_Delete(&id, r);
-                ErrorQuit("all elements of l must have the same ring", 0L, 0L);
+                _SI_ErrorQuit("all elements of l must have the same ring", 0L, 0L);
                 return Fail;
             }
         }
@@ -591,6 +690,79 @@ Obj Func_SI_ideal_from_els(Obj self, Obj l)
     return NEW_SINGOBJ_RING(SINGTYPE_IDEAL, id, r);
 }
 
+/// Installed as SI_poly method
+///
+/// Builds a polynomial directly from a list of coefficients and a flat
+/// list of exponents, which contains rVar(r) exponents for each
+/// coefficient. Coefficients may be anything _SI_NUMBER_FROM_GAP accepts,
+/// or Singular numbers over the same ring. Terms with equal monomials are
+/// added up, and terms with zero coefficient are dropped.
+Obj Func_SI_poly_from_coeffs_exps(Obj self, Obj rr, Obj coeffs, Obj exps)
+{
+    rr = UnwrapHighlevelWrapper(rr);
+    if (! ISSINGOBJ(SINGTYPE_RING_IMM, rr)) {
+        _SI_ErrorQuit("ring must be a Singular ring", 0L, 0L);
+        return Fail;
+    }
+    if (!IS_LIST(coeffs) || !IS_LIST(exps)) {
+        _SI_ErrorQuit("coeffs and exps must be lists", 0L, 0L);
+        return Fail;
+    }
+    ring r = (ring)CXX_SINGOBJ(rr);
+    UInt nrterms = LEN_LIST(coeffs);
+    UInt nrvars = rVar(r);
+    if ((UInt)LEN_LIST(exps) != nrterms * nrvars) {
+        _SI_ErrorQuit("exps must contain one exponent per variable for each coefficient", 0L, 0L);
+        return Fail;
+    }
+
+    // Check all exponents before allocating any Singular memory.
+    UInt i, j;
+    for (i = 1; i <= nrterms * nrvars; i++) {
+        Obj t = ELM_LIST(exps, i);
+        if (!IS_INTOBJ(t) || INT_INTOBJ(t) < 0 ||
+            (unsigned long)INT_INTOBJ(t) > r->bitmask) {
+            _SI_ErrorQuit("exps must contain non-negative small integers", 0L, 0L);
+            return Fail;
+        }
+    }
+
+    if (r != currRing) rChangeCurrRing(r);
+
+    // Prepend each term, then sort the whole list once. Input given in
+    // descending monomial order (e.g. from SI_ToGAP) thus arrives reversed,
+    // which p_SortAdd handles cheaply with revert = TRUE.
+    CleanupScope scope;
+    poly p = NULL;
+    _SI_AddCleanupPoly(&p, r);
+    for (i = 0; i < nrterms; i++) {
+        Obj c = ELM_LIST(coeffs, i + 1);
+        number n;
+        if (ISSINGOBJ(SINGTYPE_NUMBER_IMM, c) || ISSINGOBJ(SINGTYPE_NUMBER, c)) {
+            if (CXXRING_SINGOBJ(c) != r) {
+                _SI_ErrorQuit("coefficients must be defined over the given ring", 0L, 0L);
+                return Fail;
+            }
+            n = n_Copy((number)CXX_SINGOBJ(c), r->cf);
+        } else {
+            n = _SI_NUMBER_FROM_GAP(r, c);
+        }
+        if (n_IsZero(n, r->cf)) {
+            n_Delete(&n, r->cf);
+            continue;
+        }
+        poly m = p_Init(r);
+        pSetCoeff0(m, n);
+        for (j = 1; j <= nrvars; j++)
+            p_SetExp(m, j, INT_INTOBJ(ELM_LIST(exps, i * nrvars + j)), r);
+        p_Setm(m, r);
+        pNext(m) = p;
+        p = m;
+    }
+    p = p_SortAdd(p, r, TRUE);
+    return NEW_SINGOBJ_RING(SINGTYPE_POLY, p, r);
+}
+
 /* if needed, handle more cases */
 Obj FuncSingularValueOfVar(Obj self, Obj name)
 {
@@ -682,14 +854,72 @@ Obj Func_SI_SingularProcs(Obj self)
     return l;
 }
 
+/// Convert the poly (or vector) p over the ring r into a GAP list
+/// [ coeffs, exps ] resp. [ coeffs, exps, comps ], where exps is the
+/// flat list of exponents (rVar(r) entries per term). This is the
+/// same format as accepted by SI_poly(ring, coeffs, exps).
+static Obj _SI_POLY_TO_GAP(poly p, ring r, bool withcomps)
+{
+    Int nrvars = rVar(r);
+    Int len = pLength(p);
+    Obj coeffs = NEW_PLIST(T_PLIST, len);
+    Obj exps = NEW_PLIST(len ? T_PLIST_CYC : T_PLIST_EMPTY, len * nrvars);
+    Obj comps = 0;
+    if (withcomps)
+        comps = NEW_PLIST(len ? T_PLIST_CYC : T_PLIST_EMPTY, len);
+    Int i = 0;
+    Int pos = 0;
+    for (; p != NULL; p = pNext(p)) {
+        i++;
+        Obj c = _SI_NUMBER_TO_GAP(r, pGetCoeff(p));
+        SET_ELM_PLIST(coeffs, i, c);
+        CHANGED_BAG(coeffs);
+        for (Int j = 1; j <= nrvars; j++)
+            SET_ELM_PLIST(exps, ++pos, INTOBJ_INT(p_GetExp(p, j, r)));
+        if (withcomps)
+            SET_ELM_PLIST(comps, i, INTOBJ_INT(p_GetComp(p, r)));
+    }
+    SET_LEN_PLIST(coeffs, len);
+    SET_LEN_PLIST(exps, len * nrvars);
+
+    Obj res = NEW_PLIST(T_PLIST_DENSE, withcomps ? 3 : 2);
+    SET_ELM_PLIST(res, 1, coeffs);
+    SET_ELM_PLIST(res, 2, exps);
+    if (withcomps) {
+        SET_LEN_PLIST(comps, len);
+        SET_ELM_PLIST(res, 3, comps);
+    }
+    SET_LEN_PLIST(res, withcomps ? 3 : 2);
+    CHANGED_BAG(res);
+    return res;
+}
+
+/// Convert the generators of an ideal or module into a GAP list
+/// of results of _SI_POLY_TO_GAP.
+static Obj _SI_IDEAL_TO_GAP(ideal id, ring r, bool withcomps)
+{
+    Int len = IDELEMS(id);
+    Obj res = NEW_PLIST(len ? T_PLIST_DENSE : T_PLIST_EMPTY, len);
+    for (Int i = 0; i < len; i++) {
+        Obj tmp = _SI_POLY_TO_GAP(id->m[i], r, withcomps);
+        SET_ELM_PLIST(res, i+1, tmp);
+        CHANGED_BAG(res);
+    }
+    SET_LEN_PLIST(res, len);
+    return res;
+}
+
 /**
  * Tries to transform a singular object to a GAP object.
- * Currently does small integers and strings.
+ * Currently does strings, small integers, bigints, numbers, intvecs,
+ * intmats, bigintmats, and polynomials, vectors, ideals, modules and
+ * matrices (as lists of coefficients and exponents, see
+ * _SI_POLY_TO_GAP). Returns fail for all other objects.
  */
 Obj FuncSI_ToGAP(Obj self, Obj singobj)
 {
     if (TNUM_OBJ(singobj) != T_SINGULAR) {
-        ErrorQuit("singobj must be a wrapped Singular object", 0L, 0L);
+        _SI_ErrorQuit("singobj must be a wrapped Singular object", 0L, 0L);
         return Fail;
     }
     switch (TYPE_SINGOBJ(singobj)) {
@@ -724,6 +954,52 @@ Obj FuncSI_ToGAP(Obj self, Obj singobj)
         case SINGTYPE_BIGINTMAT_IMM: {
             return Func_SI_Matbigintmat(self, singobj);
         }
+        case SINGTYPE_NUMBER:
+        case SINGTYPE_NUMBER_IMM: {
+            number n = (number)CXX_SINGOBJ(singobj);
+            return _SI_NUMBER_TO_GAP(CXXRING_SINGOBJ(singobj), n);
+        }
+        case SINGTYPE_POLY:
+        case SINGTYPE_POLY_IMM: {
+            poly p = (poly)CXX_SINGOBJ(singobj);
+            return _SI_POLY_TO_GAP(p, CXXRING_SINGOBJ(singobj), false);
+        }
+        case SINGTYPE_VECTOR:
+        case SINGTYPE_VECTOR_IMM: {
+            poly p = (poly)CXX_SINGOBJ(singobj);
+            return _SI_POLY_TO_GAP(p, CXXRING_SINGOBJ(singobj), true);
+        }
+        case SINGTYPE_IDEAL:
+        case SINGTYPE_IDEAL_IMM: {
+            ideal id = (ideal)CXX_SINGOBJ(singobj);
+            return _SI_IDEAL_TO_GAP(id, CXXRING_SINGOBJ(singobj), false);
+        }
+        case SINGTYPE_MODULE:
+        case SINGTYPE_MODULE_IMM: {
+            ideal id = (ideal)CXX_SINGOBJ(singobj);
+            return _SI_IDEAL_TO_GAP(id, CXXRING_SINGOBJ(singobj), true);
+        }
+        case SINGTYPE_MATRIX:
+        case SINGTYPE_MATRIX_IMM: {
+            matrix m = (matrix)CXX_SINGOBJ(singobj);
+            ring r = CXXRING_SINGOBJ(singobj);
+            Int rows = MATROWS(m);
+            Int cols = MATCOLS(m);
+            Obj res = NEW_PLIST(rows ? T_PLIST_DENSE : T_PLIST_EMPTY, rows);
+            for (Int i = 1; i <= rows; i++) {
+                Obj row = NEW_PLIST(cols ? T_PLIST_DENSE : T_PLIST_EMPTY, cols);
+                SET_ELM_PLIST(res, i, row);
+                SET_LEN_PLIST(res, i);
+                CHANGED_BAG(res);
+                for (Int j = 1; j <= cols; j++) {
+                    Obj tmp = _SI_POLY_TO_GAP(MATELEM(m, i, j), r, false);
+                    SET_ELM_PLIST(row, j, tmp);
+                    SET_LEN_PLIST(row, j);
+                    CHANGED_BAG(row);
+                }
+            }
+            return res;
+        }
         default:
             return Fail;
     }
@@ -732,51 +1008,87 @@ Obj FuncSI_ToGAP(Obj self, Obj singobj)
 
 //////////////// C++ functions for the jump tables ////////////////////
 
+//! Give the wrapper obj its own copy of its payload, if that is shared
+//! with other wrappers. Call this before modifying a payload in place.
+void _SI_UnshareSingObj(Obj obj)
+{
+    void *data = CXX_SINGOBJ(obj);
+    UInt bytes = BYTES_SINGOBJ(obj);
+    if (ReleasePayload(data, &bytes)) {
+        // Take over the bytes of former sharers; they are still in the
+        // memory statistics.
+        SET_BYTES_SINGOBJ(obj, bytes);
+        return;
+    }
+    // Our bytes stay with the payload
+    SET_BYTES_SINGOBJ(obj, 0);
+
+    int gtype = TYPE_SINGOBJ(obj);
+    ring r = HasRingTable[gtype] ? CXXRING_SINGOBJ(obj) : 0;
+    sleftv tmp;
+    tmp.Init();
+    tmp.data = data;
+    tmp.rtyp = GAPtoSingType[gtype];
+    sleftv copy;
+    if (r && r != currRing)
+        rChangeCurrRing(r);
+    copy.Copy(&tmp);
+    SET_CXX_SINGOBJ(obj, copy.data);
+    _SI_SetWrapperBytes(obj, _SI_QuickByteSize(copy.rtyp, copy.data, r));
+}
+
 ///! Create a structure copy of a Singular object.
 ///! This is used as method for ShallowCopy and StructuralCopy
-///! for Singular wrapper objects in GAP.
+///! for Singular wrapper objects in GAP. The payload is not copied
+///! but shared, see _SI_UnshareSingObj.
 static Obj CopySingObj(Obj s, bool immutable)
 {
     if (TNUM_OBJ(s) != T_SINGULAR) {
-        ErrorQuit("argument must be a singular object", 0L, 0L);
+        _SI_ErrorQuit("argument must be a singular object", 0L, 0L);
         return Fail;
     }
 
     if (!IsCopyableObjSingular(s))
         return s;
 
-    sleftv obj;
-    obj.Init();
-
     int gtype = TYPE_SINGOBJ(s);
-    obj.data = CXX_SINGOBJ(s);
-    obj.rtyp = GAPtoSingType[gtype];
-    obj.flag = FLAGS_SINGOBJ(s);
-    obj.attribute = (attr)ATTRIB_SINGOBJ(s);
+    void *data = CXX_SINGOBJ(s);
     ring r = HasRingTable[gtype] ? CXXRING_SINGOBJ(s) : 0;
 
-    sleftv copy;
-    if (r && r != currRing)
-        rChangeCurrRing(r);
-    copy.Copy(&obj);
-    
     if (immutable)
         gtype = gtype | 1;
     else
         gtype = gtype & ~1;
-    
-    // Wrap it again
-    Obj res;
-    if (r) {
-        res = NEW_SINGOBJ_RING(gtype, copy.data, r);
-    } else {
-        res = NEW_SINGOBJ(gtype, copy.data);
+
+    // Accumulators own a geobucket, which cannot be shared.
+    if ((gtype & ~1) == SINGTYPE_POLYACC) {
+        if (r != currRing)
+            rChangeCurrRing(r);
+        void *copy = _SI_CopyAccumulator(data, r);
+        Obj res = NEW_SINGOBJ_RING(gtype, copy, r);
+        _SI_SetWrapperBytes(res, _SI_ByteSizeOfAccumulator(copy, r));
+        return res;
     }
 
-    if (copy.flag)
-        SET_FLAGS_SINGOBJ(res, copy.flag);
-    if (copy.attribute != NULL || copy.e != NULL)
-        SET_ATTRIB_SINGOBJ(res, (void *)copy.CopyA());
+    // Wrap the payload again; NEW_SINGOBJ is avoided here, as it would
+    // walk the whole payload to determine its size.
+    Obj res = NewBag(T_SINGULAR, BASESIZE_SINGTYPE(gtype) * sizeof(Obj));
+    SET_TYPE_SINGOBJ(res, gtype);
+    SET_FLAGS_SINGOBJ(res, FLAGS_SINGOBJ(s));
+    SET_CXX_SINGOBJ(res, data);
+    if (r)
+        SET_CXXRING_SINGOBJ(res, r);
+    SET_BYTES_SINGOBJ(res, 0);
+    _SI_NoteNewWrapper(gtype, r, 0);
+    if (data != NULL)
+        SharedPayloads[data].refs++;
+
+    attr a = (attr)ATTRIB_SINGOBJ(s);
+    if (a != NULL) {
+        if (r && r != currRing)
+            rChangeCurrRing(r);
+        SET_ATTRIB_SINGOBJ(res, (void *)a->Copy());
+    }
     return res;
 }
 
@@ -835,6 +1147,8 @@ bool IsCopyableSingularType(Int gtype)
 		case SINGTYPE_MATRIX_IMM:
 		case SINGTYPE_MODULE:
 		case SINGTYPE_MODULE_IMM:
+		case SINGTYPE_POLYACC:
+		case SINGTYPE_POLYACC_IMM:
 		case SINGTYPE_POLY:
 		case SINGTYPE_POLY_IMM:
 		case SINGTYPE_VECTOR:
@@ -842,7 +1156,7 @@ bool IsCopyableSingularType(Int gtype)
 		    return 1;
     }
 
-    ErrorQuit("IsCopyableObjSingular: unsupported singtype %d", gtype, 0);
+    _SI_ErrorQuit("IsCopyableObjSingular: unsupported singtype %d", gtype, 0);
     return 0;
 }
 
@@ -902,7 +1216,7 @@ Obj ZeroSMSingObj(Obj s)
         // Rings are always immutable!
         ring r = CXXRING_SINGOBJ(s);
         if (r == 0 || r->ext_ref == 0)
-            ErrorQuit("internal error: bad ring reference in ring dependant object", 0L, 0L);
+            _SI_ErrorQuit("internal error: bad ring reference in ring dependant object", 0L, 0L);
         return ZeroSMSingObj((Obj)r->ext_ref);
     }
     return ZeroObject(s);
@@ -930,40 +1244,17 @@ Obj OneSMSingObj(Obj s)
         // Rings are always immutable!
         ring r = CXXRING_SINGOBJ(s);
         if (r == 0 || r->ext_ref == 0)
-            ErrorQuit("internal error: bad ring reference in ring dependant object", 0L, 0L);
+            _SI_ErrorQuit("internal error: bad ring reference in ring dependant object", 0L, 0L);
         return OneSMSingObj((Obj)r->ext_ref);
     }
     return OneMutObject(s);
 }
 
-/* this is to test the performance gain, when we avoid the method selection
-for \+ of Singular polynomials by a SumFuncs function.
-The gain seem pretty small - this was tested with zero polyomials.
-So: for the moment we just leave the generic functions in the kernel
-tables.   */
-/* from GAP kernel */
-/*
-Obj SumObject(Obj l, Obj r);
-
-Obj SumSingObjs(Obj a, Obj b)
-{
-    int atype, btype;
-    atype = TYPE_SINGOBJ(a);
-    btype = TYPE_SINGOBJ(b);
-    if ((atype == SINGTYPE_POLY || atype == SINGTYPE_POLY_IMM) &&
-        (btype == SINGTYPE_POLY || btype == SINGTYPE_POLY_IMM))    {
-       return Func_SI_p_Add_q(NULL, a, b);
-    } else {
-      return SumObject(a, b);
-    }
-}
-*/
-
 Obj Func_SI_attrib( Obj self, Obj singobj )
 {
     singobj = UnwrapHighlevelWrapper(singobj);
     if (TNUM_OBJ(singobj) != T_SINGULAR)
-        ErrorQuit("argument must be singular object.", 0L, 0L);
+        _SI_ErrorQuit("argument must be singular object.", 0L, 0L);
     // TODO: for now we just return whether the
     // object has any attributes; but in the future we could
     // return a list with the actual attributes...
@@ -979,16 +1270,26 @@ Obj Func_SI_flags( Obj self, Obj singobj )
 {
     singobj = UnwrapHighlevelWrapper(singobj);
     if (TNUM_OBJ(singobj) != T_SINGULAR)
-        ErrorQuit("argument must be singular object.", 0L, 0L);
+        _SI_ErrorQuit("argument must be singular object.", 0L, 0L);
     unsigned int flags = FLAGS_SINGOBJ(singobj);
     return INTOBJ_INT(flags);
 }
 
+//! Return true if the Singular object is flagged as a standard basis,
+//! as attrib(obj, "isSB") in Singular.
+Obj FuncSI_IsSB( Obj self, Obj singobj )
+{
+    singobj = UnwrapHighlevelWrapper(singobj);
+    if (TNUM_OBJ(singobj) != T_SINGULAR)
+        _SI_ErrorQuit("argument must be singular object.", 0L, 0L);
+    return (FLAGS_SINGOBJ(singobj) & Sy_bit(FLAG_STD)) ? True : False;
+}
+
 Obj Func_SI_type( Obj self, Obj singobj )
 {
     singobj = UnwrapHighlevelWrapper(singobj);
     if (TNUM_OBJ(singobj) != T_SINGULAR)
-        ErrorQuit("argument must be singular object.", 0L, 0L);
+        _SI_ErrorQuit("argument must be singular object.", 0L, 0L);
     Int gtype = TYPE_SINGOBJ(singobj);
     return INTOBJ_INT(gtype);
 }
@@ -65,9 +65,11 @@ ops2 := rec();
 for i in [1,3..Length(SI_TOKENLIST)-1] do
     ops2.(SI_TOKENLIST[i+1]) := SI_TOKENLIST[i];
 od;
+PrintTo(s,"BindGlobal(\"_SI_OPERATION_TOKENS\", rec());\n\n");
 for op in ops do
   if IsBound(ops2.(op)) then
     nr := ops2.(op);
+    PrintTo(s,"_SI_OPERATION_TOKENS.(\"",op,"\") := ",nr,";\n");
     poss := List(SI_OPERATIONS,l->Filtered([1..Length(l)],i->l[i][1] = op));
     needring := false;
     for i in [1..3] do
@@ -330,6 +330,7 @@ GenerateSingularWrapper := function (desc)
 
 	# Declare some variables used throughout the wrapper function body.
 	PrintCXXLine("ring r = currRing;");
+	PrintCXXLine("CleanupScope scope;");
 	PrintCXXLine("");
 
 
@@ -357,20 +358,15 @@ GenerateSingularWrapper := function (desc)
 		type := SINGULAR_types.(GetParamTypeName(i));
 		# Extract the underlying Singular data from the GAP input object
 		PrintCXXLine("SingObj ",CXXObjName(i),"(",CXXArgName(i),", r);");
+		PrintCXXLine("_SI_AddCleanupObject(&",CXXObjName(i),");");
 		PrintCXXLine("if (",CXXObjName(i),".error) {");
 		indent := indent + 1;
-		    for j in [1..i] do
-				PrintCXXLine(CXXObjName(j),".cleanup();");
-			od;
-			PrintCXXLine("ErrorQuit(",CXXObjName(i),".error,0L,0L);");
+			PrintCXXLine("_SI_ErrorQuit(",CXXObjName(i),".error,0L,0L);");
 			PrintCXXLine("return Fail;");
 		indent := indent - 1;
 		PrintCXXLine("} else if (",CXXObjName(i),".obj.rtyp != ",GetParamTypeName(i),"_CMD) {");
 		indent := indent + 1;
-		    for j in [1..i] do
-				PrintCXXLine(CXXObjName(j),".cleanup();");
-			od;
-			PrintCXXLine("ErrorQuit(\"argument ",i," must be of type ",GetParamTypeName(i),"\", 0L, 0L);");
+			PrintCXXLine("_SI_ErrorQuit(\"argument ",i," must be of type ",GetParamTypeName(i),"\", 0L, 0L);");
 			PrintCXXLine("return Fail;");
 		indent := indent - 1;
 		PrintCXXLine("}");
@@ -471,6 +467,7 @@ PrintTo(stream_h, Concatenation(
 
 PrintTo(stream_cc, do_not_edit_warning);
 PrintCXXLine("#include \"lowlevel_mappings.h\"");
+PrintCXXLine("#include \"cleanup.h\"");
 PrintCXXLine("#include \"singobj.h\"");
 PrintCXXLine("");
 
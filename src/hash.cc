@@ -0,0 +1,361 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "hash.h"
+
+#include <coeffs/bigintmat.h>
+#include <coeffs/longrat.h>
+#include <Singular/lists.h>
+
+extern "C" Int EqObject(Obj opL, Obj opR);
+extern "C" Int LtObject(Obj opL, Obj opR);
+
+//////////////// Structural hashing and comparison ////////////////////
+
+// Two Singular objects are structurally equal if they have the same
+// type, are defined over the same ring (rings themselves are only equal
+// to themselves), and consist of equal entries. Structurally equal
+// objects have the same hash value.
+
+static inline UInt Mix(UInt h, UInt x)
+{
+    return h * 31 + x;
+}
+
+static UInt HashMpz(UInt h, mpz_srcptr z)
+{
+    h = Mix(h, mpz_sgn(z));
+    for (size_t i = 0; i < mpz_size(z); i++)
+        h = Mix(h, mpz_getlimbn(z, i));
+    return h;
+}
+
+static UInt HashNumber(number n, const coeffs cf)
+{
+    if (n == NULL)
+        return 0;
+    if (nCoeff_is_Q(cf)) {
+        if (SR_HDL(n) & SR_INT)
+            return SR_TO_INT(n);
+        if (n->s == 0) {
+            // Not normalized, so equal numbers may differ in their
+            // representation. Hash a normalized copy instead.
+            number c = n_Copy(n, cf);
+            n_Normalize(c, cf);
+            UInt h = HashNumber(c, cf);
+            n_Delete(&c, cf);
+            return h;
+        }
+        // Integers in the range of immediate numbers may also occur as
+        // mpz numbers, e.g. if they were not normalized after an
+        // operation; hash them like the immediate number.
+        if (n->s == 3 && mpz_fits_slong_p(n->z))
+            return (UInt)mpz_get_si(n->z);
+        UInt h = HashMpz(0, n->z);
+        if (n->s != 3)    // not an integer, so there is a denominator
+            h = HashMpz(h, n->n);
+        return h;
+    }
+    if (nCoeff_is_Zp(cf))
+        return (UInt)(long)n;
+    // For other coefficient domains, hash a few cheap invariants.
+    return Mix(n_Int(n, cf), n_Size(n, cf));
+}
+
+static UInt HashPoly(poly p, ring r)
+{
+    // Equal monomials over the same ring have equal exponent vectors,
+    // including the words derived from the monomial ordering.
+    UInt h = 0;
+    while (p != NULL) {
+        for (int i = 0; i < r->ExpL_Size; i++)
+            h = Mix(h, p->exp[i]);
+        h = Mix(h, HashNumber(pGetCoeff(p), r->cf));
+        pIter(p);
+    }
+    return h;
+}
+
+static UInt HashPolyArray(poly *m, int n, ring r)
+{
+    UInt h = n;
+    for (int i = 0; i < n; i++)
+        h = Mix(h, HashPoly(m[i], r));
+    return h;
+}
+
+//! Compute a hash value of a Singular object of type rtyp with the
+//! given data. For ring dependent objects, r must be the base ring.
+UInt _SI_Hash(int rtyp, void *data, ring r)
+{
+    if (data == NULL)
+        return 0;
+    switch (rtyp) {
+        case INT_CMD:
+            return (UInt)(long)data;
+        case POLY_CMD:
+        case VECTOR_CMD:
+            return HashPoly((poly)data, r);
+        case IDEAL_CMD:
+        case MODUL_CMD: {
+            ideal id = (ideal)data;
+            return Mix(id->rank, HashPolyArray(id->m, IDELEMS(id), r));
+        }
+        case MATRIX_CMD: {
+            matrix mat = (matrix)data;
+            return Mix(MATROWS(mat), HashPolyArray(mat->m,
+                                        MATROWS(mat) * MATCOLS(mat), r));
+        }
+        case NUMBER_CMD:
+            return HashNumber((number)data, r->cf);
+        case BIGINT_CMD:
+            return HashNumber((number)data, coeffs_BIGINT);
+        case INTVEC_CMD:
+        case INTMAT_CMD: {
+            intvec *iv = (intvec *)data;
+            UInt h = Mix(iv->rows(), iv->cols());
+            for (int i = 0; i < iv->length(); i++)
+                h = Mix(h, (*iv)[i]);
+            return h;
+        }
+        case BIGINTMAT_CMD: {
+            bigintmat *bim = (bigintmat *)data;
+            UInt h = Mix(bim->rows(), bim->cols());
+            for (int i = 1; i <= bim->rows(); i++)
+                for (int j = 1; j <= bim->cols(); j++)
+                    h = Mix(h, HashNumber(bim->view(i, j), bim->basecoeffs()));
+            return h;
+        }
+        case STRING_CMD: {
+            UInt h = 0;
+            for (const char *s = (const char *)data; *s; s++)
+                h = Mix(h, (unsigned char)*s);
+            return h;
+        }
+        case LIST_CMD: {
+            lists l = (lists)data;
+            UInt h = l->nr + 1;
+            for (int i = 0; i <= l->nr; i++)
+                h = Mix(h, Mix(l->m[i].Typ(),
+                               _SI_Hash(l->m[i].Typ(), l->m[i].Data(), r)));
+            return h;
+        }
+        default:
+            // Rings, maps, resolutions, links, ...: use the identity.
+            return (UInt)data;
+    }
+}
+
+static bool EqualPolyArray(poly *a, poly *b, int n, ring r)
+{
+    for (int i = 0; i < n; i++)
+        if (!p_EqualPolys(a[i], b[i], r))
+            return false;
+    return true;
+}
+
+//! Check whether two Singular objects of type rtyp over the ring r
+//! are structurally equal.
+bool _SI_Equal(int rtyp, void *a, void *b, ring r)
+{
+    if (a == b)
+        return true;
+    if (a == NULL || b == NULL)
+        return false;
+    switch (rtyp) {
+        case INT_CMD:
+            return false;   // a != b
+        case POLY_CMD:
+        case VECTOR_CMD:
+            return p_EqualPolys((poly)a, (poly)b, r);
+        case IDEAL_CMD:
+        case MODUL_CMD: {
+            ideal ia = (ideal)a, ib = (ideal)b;
+            return ia->rank == ib->rank && IDELEMS(ia) == IDELEMS(ib) &&
+                   EqualPolyArray(ia->m, ib->m, IDELEMS(ia), r);
+        }
+        case MATRIX_CMD: {
+            matrix ma = (matrix)a, mb = (matrix)b;
+            return MATROWS(ma) == MATROWS(mb) && MATCOLS(ma) == MATCOLS(mb) &&
+                   EqualPolyArray(ma->m, mb->m, MATROWS(ma) * MATCOLS(ma), r);
+        }
+        case NUMBER_CMD:
+            return n_Equal((number)a, (number)b, r->cf);
+        case BIGINT_CMD:
+            return n_Equal((number)a, (number)b, coeffs_BIGINT);
+        case INTVEC_CMD:
+        case INTMAT_CMD: {
+            intvec *ia = (intvec *)a, *ib = (intvec *)b;
+            return ia->rows() == ib->rows() && ia->cols() == ib->cols() &&
+                   ia->compare(ib) == 0;
+        }
+        case BIGINTMAT_CMD: {
+            bigintmat *ba = (bigintmat *)a, *bb = (bigintmat *)b;
+            return ba->rows() == bb->rows() && ba->cols() == bb->cols() &&
+                   ba->basecoeffs() == bb->basecoeffs() && *ba == *bb;
+        }
+        case STRING_CMD:
+            return strcmp((const char *)a, (const char *)b) == 0;
+        case LIST_CMD: {
+            lists la = (lists)a, lb = (lists)b;
+            if (la->nr != lb->nr)
+                return false;
+            for (int i = 0; i <= la->nr; i++) {
+                int t = la->m[i].Typ();
+                if (t != lb->m[i].Typ() ||
+                    !_SI_Equal(t, la->m[i].Data(), lb->m[i].Data(), r))
+                    return false;
+            }
+            return true;
+        }
+        default:
+            return false;   // a != b
+    }
+}
+
+//! Hash value of a Singular wrapper object. It does not depend on the
+//! mutability of the object.
+UInt _SI_HashSingObj(Obj obj)
+{
+    int gtype = TYPE_SINGOBJ(obj);
+    ring r = HasRingTable[gtype] ? CXXRING_SINGOBJ(obj) : 0;
+    UInt h = Mix(gtype & ~1, (UInt)r);
+    return Mix(h, _SI_Hash(GAPtoSingType[gtype], CXX_SINGOBJ(obj), r));
+}
+
+//! Check whether two Singular wrapper objects are structurally equal,
+//! ignoring their mutability.
+bool _SI_EqualSingObj(Obj a, Obj b)
+{
+    int gtype = TYPE_SINGOBJ(a);
+    if ((gtype & ~1) != (TYPE_SINGOBJ(b) & ~1))
+        return false;
+    ring r = 0;
+    if (HasRingTable[gtype]) {
+        r = CXXRING_SINGOBJ(a);
+        if (r != CXXRING_SINGOBJ(b))
+            return false;
+    }
+    return _SI_Equal(GAPtoSingType[gtype], CXX_SINGOBJ(a), CXX_SINGOBJ(b), r);
+}
+
+// Types whose equality is decided structurally by EqSingObj; for all
+// others, comparisons are left to the Singular interpreter.
+static bool HasNativeEq(int rtyp)
+{
+    switch (rtyp) {
+        case INT_CMD:
+        case POLY_CMD:
+        case VECTOR_CMD:
+        case IDEAL_CMD:
+        case MODUL_CMD:
+        case MATRIX_CMD:
+        case NUMBER_CMD:
+        case BIGINT_CMD:
+        case INTVEC_CMD:
+        case INTMAT_CMD:
+        case BIGINTMAT_CMD:
+        case STRING_CMD:
+            return true;
+    }
+    return false;
+}
+
+//! Compare two Singular objects for equality. It is installed in
+//! EqFuncs, so that comparing two objects of the same type over the same
+//! ring avoids the method selection and the interpreter.
+Int EqSingObj(Obj a, Obj b)
+{
+    int gtype = TYPE_SINGOBJ(a);
+    if ((gtype & ~1) != (TYPE_SINGOBJ(b) & ~1) ||
+        !HasNativeEq(GAPtoSingType[gtype]) ||
+        (HasRingTable[gtype] && CXXRING_SINGOBJ(a) != CXXRING_SINGOBJ(b)))
+        return EqObject(a, b);
+    return _SI_EqualSingObj(a, b);
+}
+
+// Compare two numbers; returns -1, 0 or 1. For coefficient domains
+// without a natural order this is only as good as n_Greater.
+static int CmpNumber(number a, number b, const coeffs cf)
+{
+    if (n_Equal(a, b, cf))
+        return 0;
+    return n_Greater(a, b, cf) ? 1 : -1;
+}
+
+// Compare two polynomials or vectors term by term, starting with the
+// leading terms: the first pair of different monomials decides with
+// respect to the monomial order of r, equal monomials are compared by
+// their coefficients. A polynomial that is a leading part of the other
+// one is the smaller one; in particular, 0 is smaller than any other
+// polynomial.
+static int CmpPoly(poly a, poly b, ring r)
+{
+    for (; a != NULL && b != NULL; pIter(a), pIter(b)) {
+        int c = p_LmCmp(a, b, r);
+        if (c != 0)
+            return c;
+        c = CmpNumber(pGetCoeff(a), pGetCoeff(b), r->cf);
+        if (c != 0)
+            return c;
+    }
+    if (a == b)     // both are NULL
+        return 0;
+    return (a == NULL) ? -1 : 1;
+}
+
+//! Check whether a is smaller than b. It is installed in LtFuncs, so that
+//! polynomials, vectors, numbers and bigints over the same ring can be
+//! sorted without the method selection and the interpreter; see CmpPoly
+//! for the order on polynomials and vectors. All other comparisons are
+//! left to the GAP methods.
+Int LtSingObj(Obj a, Obj b)
+{
+    int gtype = TYPE_SINGOBJ(a);
+    if ((gtype & ~1) != (TYPE_SINGOBJ(b) & ~1) ||
+        (HasRingTable[gtype] && CXXRING_SINGOBJ(a) != CXXRING_SINGOBJ(b)))
+        return LtObject(a, b);
+    ring r = HasRingTable[gtype] ? CXXRING_SINGOBJ(a) : 0;
+    switch (gtype & ~1) {
+        case SINGTYPE_POLY:
+        case SINGTYPE_VECTOR:
+            if (r != currRing)
+                rChangeCurrRing(r);
+            return CmpPoly((poly)CXX_SINGOBJ(a), (poly)CXX_SINGOBJ(b), r) < 0;
+        case SINGTYPE_NUMBER:
+            return CmpNumber((number)CXX_SINGOBJ(a), (number)CXX_SINGOBJ(b),
+                             r->cf) < 0;
+        case SINGTYPE_BIGINT:
+            return CmpNumber((number)CXX_SINGOBJ(a), (number)CXX_SINGOBJ(b),
+                             coeffs_BIGINT) < 0;
+    }
+    return LtObject(a, b);
+}
+
+//! Return a hash value of a Singular object, as a small non-negative
+//! integer. Equal objects have the same hash value. The hash value of
+//! a mutable object changes when it is modified.
+Obj FuncSI_Hash(Obj self, Obj obj)
+{
+    if (TNUM_OBJ(obj) != T_SINGULAR)
+        _SI_ErrorQuit("SI_Hash: argument must be a Singular object", 0L, 0L);
+    return INTOBJ_INT(_SI_HashSingObj(obj) & 0xFFFFFFF);
+}
@@ -0,0 +1,37 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef LIBSING_HASH_H
+#define LIBSING_HASH_H
+
+#include "libsing.h"
+
+UInt _SI_Hash(int rtyp, void *data, ring r);
+bool _SI_Equal(int rtyp, void *a, void *b, ring r);
+
+UInt _SI_HashSingObj(Obj obj);
+bool _SI_EqualSingObj(Obj a, Obj b);
+
+Int EqSingObj(Obj a, Obj b);
+Int LtSingObj(Obj a, Obj b);
+Obj FuncSI_Hash(Obj self, Obj obj);
+
+#endif
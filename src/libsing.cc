@@ -19,9 +19,15 @@
  */
 
 #include "libsing.h"
+#include "accumulator.h"
+#include "arith.h"
 #include "lowlevel_mappings.h"
 #include "singtypes.h"
+#include "hash.h"
 #include "matrix.h"
+#include "memo.h"
+#include "memory.h"
+#include "parse.h"
 
 /******************** The interface to GAP ***************/
 
@@ -57,20 +63,38 @@ static StructGVarFunc GVarFuncs[] = {
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_intvec, 1, "l"),
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_Plistintvec, 1, "iv"),
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_ideal_from_els, 1, "l"),
+    GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_poly_from_coeffs_exps, 3, "ring, coeffs, exps"),
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", SI_RingOfSingobj, 1, "singobj"),
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_OmPrintInfo, 0, ""),
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_OmCurrentBytes, 0, ""),
 
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_attrib, 1, "singobj"),
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_flags, 1, "singobj"),
+    GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", SI_IsSB, 1, "singobj"),
     GVAR_FUNC_TABLE_ENTRY("cxxfuncs.cc", _SI_type, 1, "singobj"),
 
+    GVAR_FUNC_TABLE_ENTRY("accumulator.cc", SI_PolyAccumulator, 1, "r"),
+    GVAR_FUNC_TABLE_ENTRY("accumulator.cc", SI_AccumulatorAdd, 2, "a, p"),
+    GVAR_FUNC_TABLE_ENTRY("accumulator.cc", SI_AccumulatorAddScaled, 4, "a, c, m, p"),
+    GVAR_FUNC_TABLE_ENTRY("accumulator.cc", SI_AccumulatorResult, 1, "a"),
+    GVAR_FUNC_TABLE_ENTRY("accumulator.cc", SI_LinearCombination, 2, "coeffs, polys"),
+
+    GVAR_FUNC_TABLE_ENTRY("arith.cc", SI_AddInPlace, 2, "a, b"),
+    GVAR_FUNC_TABLE_ENTRY("arith.cc", SI_AddScaledInPlace, 4, "a, c, m, b"),
+    GVAR_FUNC_TABLE_ENTRY("arith.cc", SI_MultInPlace, 2, "a, c"),
+
     GVAR_FUNC_TABLE_ENTRY("calls.cc", _SI_CallFunc1, 3, "r, op, input"),
     GVAR_FUNC_TABLE_ENTRY("calls.cc", _SI_CallFunc2, 4, "r, op, a, b"),
     GVAR_FUNC_TABLE_ENTRY("calls.cc", _SI_CallFunc3, 5, "r, op, a, b, c"),
     GVAR_FUNC_TABLE_ENTRY("calls.cc", _SI_CallFuncM, 3, "r, op, arg"),
+    GVAR_FUNC_TABLE_ENTRY("calls.cc", _SI_CallFuncBatch, 3, "r, op, tuples"),
     GVAR_FUNC_TABLE_ENTRY("calls.cc",  SI_SetCurrRing, 1, "r"),
     GVAR_FUNC_TABLE_ENTRY("calls.cc",  SI_CallProc, 2, "name, args"),
+    GVAR_FUNC_TABLE_ENTRY("calls.cc", _SI_ResolveProc, 1, "name"),
+    GVAR_FUNC_TABLE_ENTRY("calls.cc", _SI_ProcGeneration, 0, ""),
+    GVAR_FUNC_TABLE_ENTRY("calls.cc",  SI_SetOutputCapture, 1, "mode"),
+
+    GVAR_FUNC_TABLE_ENTRY("hash.cc", SI_Hash, 1, "obj"),
 
     GVAR_FUNC_TABLE_ENTRY("matrix.cc", _SI_bigintmat, 1, "m"),
     GVAR_FUNC_TABLE_ENTRY("matrix.cc", _SI_Matbigintmat, 1, "im"),
@@ -80,12 +104,31 @@ static StructGVarFunc GVarFuncs[] = {
     GVAR_FUNC_TABLE_ENTRY("matrix.cc", _SI_MatElm, 3, "mat, row, col"),
     GVAR_FUNC_TABLE_ENTRY("matrix.cc", _SI_SetMatElm, 4, "mat, row, col, val"),
 
+    GVAR_FUNC_TABLE_ENTRY("memo.cc", SI_SetMemoLimit, 1, "limit"),
+    GVAR_FUNC_TABLE_ENTRY("memo.cc", SI_MemoizeProcs, 1, "names"),
+    GVAR_FUNC_TABLE_ENTRY("memo.cc", SI_MemoStats, 0, ""),
+
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_SetGCPolicy, 1, "policy"),
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_GCPolicy, 0, ""),
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_MemoryStats, 0, ""),
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_ResetMemoryStats, 0, ""),
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_ByteSize, 1, "obj"),
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_GCStats, 0, ""),
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_ResetGCStats, 0, ""),
+    GVAR_FUNC_TABLE_ENTRY("memory.cc", SI_SetMemoryLimit, 1, "limit"),
+
+    GVAR_FUNC_TABLE_ENTRY("parse.cc", _SI_poly_from_String, 2, "ring, st"),
+    GVAR_FUNC_TABLE_ENTRY("parse.cc", _SI_vector_from_String, 2, "ring, st"),
+    GVAR_FUNC_TABLE_ENTRY("parse.cc", _SI_ideal_from_String, 2, "ring, st"),
+    GVAR_FUNC_TABLE_ENTRY("parse.cc", _SI_matrix_from_String, 4, "ring, nrrows, nrcols, st"),
+
 #include "lowlevel_mappings_table.h"
 
     { 0 } /* Finish with an empty entry */
 };
 
 Obj _SI_ProxiesType;
+Obj _SI_ProcHandleType;
 UInt _SI_internalRingRNam;
 
 /** 
@@ -94,9 +137,14 @@ call it to convert finite field elements to integers.
 */
 Obj SI_IntFFE;
 
+/**
+Kernel copy of the GAP object returned by Singular calls that were
+aborted because they exceeded the memory limit, see SI_SetMemoryLimit().
+*/
+Obj SI_MemoryLimitExceeded;
+
 
 // This is defined in arith.c but not exported in arith.h:
-extern "C" Int EqObject(Obj opL, Obj opR);
 extern "C" Int InObject(Obj opL, Obj opR);
 
 // The following are not exported in lists.h:
@@ -134,7 +182,10 @@ static Int InitKernel(StructInitInfo* module)
     InitSingTypesFromKernel();
 
     InitCopyGVar("_SI_ProxiesType", &_SI_ProxiesType);
+    InitCopyGVar("_SI_ProcHandleType", &_SI_ProcHandleType);
     InitFopyGVar( "IntFFE", &SI_IntFFE );
+    InitCopyGVar( "SI_MemoryLimitExceeded", &SI_MemoryLimitExceeded );
+    _SI_InitMemo();
 
     TypeObjFuncs[T_SINGULAR] = _SI_TypeObj;
     InfoBags[T_SINGULAR].name = "singular wrapper object";
@@ -146,11 +197,8 @@ static Int InitKernel(StructInitInfo* module)
      * AInvMutFuncs fuer T_SINGULAR ist AInvMutObject, OK?
      * InvFuncs fuer T_SINGULAR ist InvObject, OK?
      * InvMutFuncs fuer T_SINGULAR ist InvMutObject, OK?
-     * EqFuncs fuer T_SINGULAR/T_SINGULAR
-     * LtFuncs fuer T_SINGULAR/T_SINGULAR ist LtObject, OK?
      // InFuncs fuer T_SINGULAR/T_SINGULAR
      * SumFuncs fuer T_SINGULAR/T_SINGULAR ist SumObject, OK?
-     // SumFuncs[T_SINGULAR][T_SINGULAR] = SumSingObjs;
      * DiffFuncs fuer T_SINGULAR/T_SINGULAR ist DiffObject, OK?
      * ProdFuncs fuer T_SINGULAR/T_SINGULAR ist ProdObject, OK?
      * QuoFuncs fuer T_SINGULAR/T_SINGULAR ist QuoObject, OK?
@@ -172,7 +220,8 @@ static Int InitKernel(StructInitInfo* module)
     InFuncs[T_SINGULAR][T_SINGULAR] = InObject;
     ZeroFuncs[T_SINGULAR] = ZeroSMSingObj;
     OneMutFuncs[T_SINGULAR] = OneSMSingObj;
-    EqFuncs[T_SINGULAR][T_SINGULAR] = EqObject;
+    EqFuncs[T_SINGULAR][T_SINGULAR] = EqSingObj;
+    LtFuncs[T_SINGULAR][T_SINGULAR] = LtSingObj;
     IsListFuncs[ T_SINGULAR ] = IsListObject;
     IsSmallListFuncs[ T_SINGULAR ] = IsSmallListObject;
     LenListFuncs[ T_SINGULAR ] = LenListObject;
@@ -195,6 +244,20 @@ static Int InitKernel(StructInitInfo* module)
     IsPossListFuncs[ T_SINGULAR ] = IsPossListObject;
     PosListFuncs[ T_SINGULAR ] = PosListObject;
 
+    // Arithmetic for common types, see arith.cc
+    SumFuncs[T_SINGULAR][T_SINGULAR] = SumSingObj;
+    SumFuncs[T_SINGULAR][T_INT] = SumSingObj;
+    SumFuncs[T_INT][T_SINGULAR] = SumSingObj;
+    DiffFuncs[T_SINGULAR][T_SINGULAR] = DiffSingObj;
+    DiffFuncs[T_SINGULAR][T_INT] = DiffSingObj;
+    DiffFuncs[T_INT][T_SINGULAR] = DiffSingObj;
+    ProdFuncs[T_SINGULAR][T_SINGULAR] = ProdSingObj;
+    ProdFuncs[T_SINGULAR][T_INT] = ProdSingObj;
+    ProdFuncs[T_INT][T_SINGULAR] = ProdSingObj;
+    QuoFuncs[T_SINGULAR][T_SINGULAR] = QuoSingObj;
+    PowFuncs[T_SINGULAR][T_INT] = PowSingObj;
+    AInvFuncs[T_SINGULAR] = AInvSingObj;
+
     InstallPrePostGCFuncs();
 
     /* return success                                                      */
@@ -58,8 +58,10 @@ extern UInt _SI_LastErrorStringGVar;
 extern UInt _SI_LastOutputStringGVar;
 
 extern Obj _SI_ProxiesType;   //!< A kernel copy of the type of proxy elements
+extern Obj _SI_ProcHandleType; //!< A kernel copy of the type of proc handles
 
 extern Obj SI_IntFFE;
+extern Obj SI_MemoryLimitExceeded; //!< returned by calls aborted by the memory limit
 
 void InstallPrePostGCFuncs(void);
 
@@ -69,19 +71,26 @@ extern void _SI_ErrorCallback(const char *st);
 //////////////// Layout of the T_SINGULAR objects /////////////////////
 // There are 3 possibilites:
 // (1) objects without a ring (2) objects with a ring (3) ring objects.
-// Objects in case (1) consists of two words:
+// Objects in case (1) consists of three words:
 // First is the GAP type as a small integer pointing into a plain list
 // together with some bits for the special attributes.
 // Second is a pointer to a C++ singular object.
 // These are the same for all objects.
-// For type (2) there are three words, the first two are as above:
+// Third is the estimated number of bytes used by the Singular object.
+// For type (2) there are four words, the first two are as above:
 // Third is a pointer to the C++ Singular ring object.
-// For type (3) there are four words, the first two are as above:
+// Fourth is the estimated number of bytes used by the Singular object.
+// For type (3) there are seven words, the first two are as above:
 // Third is a reference to the canonical GAP wrapper of the ring's zero.
 // Fourth is a reference to the canonical GAP wrapper of the ring's one.
+// Fifth is a reference to the highlevel GAP wrapper of the ring.
+// Sixth is a Singular interpreter handle (idhdl) for the ring, which
+// is created on demand, see _SI_RingHdl.
+// Seventh is the estimated number of bytes used by the ring.
 //
-// Additionally, all object wrappers can have an additional word
-// for the extended attributes.
+// So in all cases, the last word holds the number of bytes, see
+// BYTES_SINGOBJ. Additionally, all object wrappers can have an
+// additional word for the extended attributes.
 
 #ifdef SYS_IS_64_BIT
 
@@ -193,17 +202,46 @@ inline void SET_HIWRAP_SINGOBJ( Obj obj, Obj hi )
     ADDR_OBJ(obj)[4] = hi;
 }
 
+inline idhdl RINGHDL_SINGOBJ( Obj obj )
+{
+    return (idhdl)ADDR_OBJ(obj)[5];
+}
 
-///! Get Singular attributes from a Singular wrapper object, if any.
-inline void *ATTRIB_SINGOBJ( Obj obj )
+inline void SET_RINGHDL_SINGOBJ( Obj obj, idhdl h )
+{
+    ADDR_OBJ(obj)[5] = (Obj)h;
+}
+
+
+///! Number of words of a wrapper object with the given GAP type,
+///! not counting the optional word for the attributes.
+inline Int BASESIZE_SINGTYPE( Int t )
 {
-    Int t = TYPE_SINGOBJ(obj);
-    Int basesize = 2;
     if (t == SINGTYPE_RING_IMM || t == SINGTYPE_QRING_IMM)
-        basesize = 5;
+        return 7;
     else if (HasRingTable[t])
-        basesize = 4;
+        return 4;
+    return 3;
+}
+
+///! Get the estimated number of bytes used by the Singular object
+///! inside a wrapper object.
+inline UInt BYTES_SINGOBJ( Obj obj )
+{
+    return (UInt)ADDR_OBJ(obj)[BASESIZE_SINGTYPE(TYPE_SINGOBJ(obj)) - 1];
+}
+
+///! Set the estimated number of bytes used by the Singular object
+///! inside a wrapper object.
+inline void SET_BYTES_SINGOBJ( Obj obj, UInt bytes )
+{
+    ADDR_OBJ(obj)[BASESIZE_SINGTYPE(TYPE_SINGOBJ(obj)) - 1] = (Obj)bytes;
+}
 
+///! Get Singular attributes from a Singular wrapper object, if any.
+inline void *ATTRIB_SINGOBJ( Obj obj )
+{
+    Int basesize = BASESIZE_SINGTYPE(TYPE_SINGOBJ(obj));
     if (SIZE_BAG(obj) <= basesize * sizeof(Obj))
         return NULL;
     return (void *)(ADDR_OBJ(obj)[basesize]);
@@ -212,22 +250,62 @@ inline void *ATTRIB_SINGOBJ( Obj obj )
 ///! Store Singular attributes inside a Singular wrapper object.
 inline void SET_ATTRIB_SINGOBJ( Obj obj, void *a )
 {
-    Int t = TYPE_SINGOBJ(obj);
-    Int basesize = 2;
-    if (t == SINGTYPE_RING_IMM || t == SINGTYPE_QRING_IMM)
-        basesize = 5;
-    else if (HasRingTable[t])
-        basesize = 4;
-
+    Int basesize = BASESIZE_SINGTYPE(TYPE_SINGOBJ(obj));
     if (SIZE_BAG(obj) <= basesize * sizeof(Obj))
         ResizeBag(obj, (basesize + 1) * sizeof(Obj));
     ADDR_OBJ(obj)[basesize] = (Obj)a;
 }
 
+///! Get the cache of derived properties of a Singular wrapper object,
+///! a plain list (see calls.cc), or NULL. It is stored after the word
+///! for the attributes.
+inline Obj CACHE_SINGOBJ( Obj obj )
+{
+    Int basesize = BASESIZE_SINGTYPE(TYPE_SINGOBJ(obj));
+    if (SIZE_BAG(obj) <= (basesize + 1) * sizeof(Obj))
+        return NULL;
+    return ADDR_OBJ(obj)[basesize + 1];
+}
+
+///! Store the cache of derived properties inside a Singular wrapper
+///! object. If necessary, this adds an empty attribute word.
+inline void SET_CACHE_SINGOBJ( Obj obj, Obj cache )
+{
+    Int basesize = BASESIZE_SINGTYPE(TYPE_SINGOBJ(obj));
+    if (SIZE_BAG(obj) <= (basesize + 1) * sizeof(Obj))
+        ResizeBag(obj, (basesize + 2) * sizeof(Obj));
+    ADDR_OBJ(obj)[basesize + 1] = cache;
+    CHANGED_BAG(obj);
+}
+
+///! The global Singular settings which affect the results of commands
+///! like std: the option bits and the degree and multiplicity bounds.
+struct SingularOptions {
+    BITSET opt1;
+    BITSET opt2;
+    int degBound;   // Kstd1_deg
+    int multBound;  // Kstd1_mu
+
+    void get()
+    {
+        opt1 = si_opt_1;
+        opt2 = si_opt_2;
+        degBound = Kstd1_deg;
+        multBound = Kstd1_mu;
+    }
+
+    bool current() const
+    {
+        return opt1 == si_opt_1 && opt2 == si_opt_2 &&
+               degBound == Kstd1_deg && multBound == Kstd1_mu;
+    }
+};
+
 
 Obj NEW_SINGOBJ(UInt type, void *cxx);
 Obj NEW_SINGOBJ_RING(UInt type, void *cxx, ring r);
 Obj NEW_SINGOBJ_ZERO_ONE(UInt type, ring r, Obj zero, Obj one);
+idhdl _SI_RingHdl(ring r);
 
 #if 0
 proxies fuer:
@@ -256,6 +334,7 @@ Obj UnwrapHighlevelWrapper(Obj obj);
 
 void _SI_ObjMarkFunc(Bag o);
 void _SI_FreeFunc(Obj o);
+void _SI_UnshareSingObj(Obj obj);
 Obj _SI_TypeObj(Obj o);
 Obj Func_SI_ring(Obj self, Obj charact, Obj names, Obj orderings);
 Obj FuncSI_RingOfSingobj( Obj self, Obj singobj );
@@ -265,21 +344,28 @@ Obj FuncSingularValueOfVar(Obj self, Obj name);
 Obj Func_SI_SingularProcs(Obj self);
 Obj FuncSI_ToGAP(Obj self, Obj singobj);
 Obj FuncSingularLastOutput(Obj self);
+Obj FuncSI_SetOutputCapture(Obj self, Obj mode);
 Obj Func_SI_bigint(Obj self, Obj nr);
 Obj Func_SI_Intbigint(Obj self, Obj b);
 Obj Func_SI_number(Obj self, Obj r, Obj nr);
 Obj Func_SI_intvec(Obj self, Obj l);
 Obj Func_SI_Plistintvec(Obj self, Obj iv);
 Obj Func_SI_ideal_from_els(Obj self, Obj l);
+Obj Func_SI_poly_from_coeffs_exps(Obj self, Obj rr, Obj coeffs, Obj exps);
 
 Obj Func_SI_CallFunc1(Obj self, Obj ringOrZero, Obj op, Obj a);
 Obj Func_SI_CallFunc2(Obj self, Obj ringOrZero, Obj op, Obj a, Obj b);
 Obj Func_SI_CallFunc3(Obj self, Obj ringOrZero, Obj op, Obj a, Obj b, Obj c);
 Obj Func_SI_CallFuncM(Obj self, Obj ringOrZero, Obj op, Obj arg);
+Obj Func_SI_CallFuncBatch(Obj self, Obj ringOrZero, Obj op, Obj tuples);
 
 Obj FuncSI_SetCurrRing(Obj self, Obj r);
 
 Obj FuncSI_CallProc(Obj self, Obj name, Obj args);
+Obj Func_SI_ResolveProc(Obj self, Obj name);
+void _SI_InvalidateProcHandles();
+Obj Func_SI_ProcGeneration(Obj self);
+void _SI_AbortPrintCapture();
 
 Obj Func_SI_OmPrintInfo(Obj self);
 Obj Func_SI_OmCurrentBytes(Obj self);
@@ -298,6 +384,7 @@ Obj OneSMSingObj(Obj s);
 
 Obj Func_SI_attrib( Obj self, Obj singobj );
 Obj Func_SI_flags( Obj self, Obj singobj );
+Obj FuncSI_IsSB( Obj self, Obj singobj );
 Obj Func_SI_type( Obj self, Obj singobj );
 
 #endif //#define LIBSING_H
@@ -20,6 +20,8 @@
 
 #include "matrix.h"
 #include "number.h"
+#include "memory.h"
+#include "cleanup.h"
 
 #include <coeffs/bigintmat.h>
 
@@ -29,26 +31,26 @@ Obj Func_SI_bigintmat(Obj self, Obj m)
     // TODO: This function is untested! add test cases!!!
     if (! (IS_LIST(m) && LEN_LIST(m) > 0 &&
            IS_LIST(ELM_LIST(m, 1)) && LEN_LIST(ELM_LIST(m, 1)) > 0)) {
-        ErrorQuit("m must be a list of lists", 0L, 0L);
+        _SI_ErrorQuit("m must be a list of lists", 0L, 0L);
         return Fail;
     }
     Int rows = LEN_LIST(m);
     Int cols = LEN_LIST(ELM_LIST(m, 1));
     Int r, c;
     Obj therow;
+    CleanupScope scope;
     bigintmat *bim = new bigintmat(rows, cols, coeffs_BIGINT);
+    _SI_AddCleanupDelete(&bim);
     for (r = 1; r <= rows; r++) {
-        therow = ELM_LIST(m, r);
-        if (! (IS_LIST(therow) && LEN_LIST(therow) == cols)) {
-            delete bim;
-            ErrorQuit("m must be a matrix", 0L, 0L);
+        therow = ELM0_LIST(m, r);
+        if (! (therow != 0 && IS_LIST(therow) && LEN_LIST(therow) == cols)) {
+            _SI_ErrorQuit("m must be a matrix", 0L, 0L);
             return Fail;
         }
         for (c = 1; c <= cols; c++) {
-            Obj t = ELM_LIST(therow, c);
-            if (! (IS_INTOBJ(t) || TNUM_OBJ(t) == T_INTPOS || TNUM_OBJ(t) == T_INTNEG)) {
-                delete bim;
-                ErrorQuit("m must contain integers", 0L, 0L);
+            Obj t = ELM0_LIST(therow, c);
+            if (! (t != 0 && (IS_INTOBJ(t) || TNUM_OBJ(t) == T_INTPOS || TNUM_OBJ(t) == T_INTNEG))) {
+                _SI_ErrorQuit("m must contain integers", 0L, 0L);
             }
             BIMATELEM(*bim, r, c) = _SI_BIGINT_FROM_GAP(t);
         }
@@ -62,7 +64,7 @@ Obj Func_SI_Matbigintmat(Obj self, Obj im)
 {
     if (!(ISSINGOBJ(SINGTYPE_BIGINTMAT_IMM, im) ||
           ISSINGOBJ(SINGTYPE_BIGINTMAT, im))) {
-        ErrorQuit("im must be a singular bigintmat", 0L, 0L);
+        _SI_ErrorQuit("im must be a singular bigintmat", 0L, 0L);
         return Fail;
     }
     bigintmat *bim = (bigintmat *)CXX_SINGOBJ(im);
@@ -92,30 +94,30 @@ Obj Func_SI_intmat(Obj self, Obj m)
 {
     if (! (IS_LIST(m) && LEN_LIST(m) > 0 &&
            IS_LIST(ELM_LIST(m, 1)) && LEN_LIST(ELM_LIST(m, 1)) > 0)) {
-        ErrorQuit("m must be a list of lists", 0L, 0L);
+        _SI_ErrorQuit("m must be a list of lists", 0L, 0L);
         return Fail;
     }
     Int rows = LEN_LIST(m);
     Int cols = LEN_LIST(ELM_LIST(m, 1));
     Int r, c;
     Obj therow;
+    CleanupScope scope;
     intvec *iv = new intvec(rows, cols, 0);
+    _SI_AddCleanupDelete(&iv);
     for (r = 1; r <= rows; r++) {
-        therow = ELM_LIST(m, r);
-        if (! (IS_LIST(therow) && LEN_LIST(therow) == cols)) {
-            delete iv;
-            ErrorQuit("m must be a matrix", 0L, 0L);
+        therow = ELM0_LIST(m, r);
+        if (! (therow != 0 && IS_LIST(therow) && LEN_LIST(therow) == cols)) {
+            _SI_ErrorQuit("m must be a matrix", 0L, 0L);
             return Fail;
         }
         for (c = 1; c <= cols; c++) {
-            Obj t = ELM_LIST(therow, c);
-            if (!IS_INTOBJ(t)
+            Obj t = ELM0_LIST(therow, c);
+            if (t == 0 || !IS_INTOBJ(t)
 #ifdef SYS_IS_64_BIT
                 || (INT_INTOBJ(t) < -(1L << 31) || INT_INTOBJ(t) >= (1L << 31))
 #endif
                ) {
-                delete iv;
-                ErrorQuit("m must contain small integers", 0L, 0L);
+                _SI_ErrorQuit("m must contain small integers", 0L, 0L);
             }
             IMATELEM(*iv, r, c) = (int) (INT_INTOBJ(t));
         }
@@ -129,7 +131,7 @@ Obj Func_SI_Matintmat(Obj self, Obj im)
 {
     if (!(ISSINGOBJ(SINGTYPE_INTMAT_IMM, im) ||
           ISSINGOBJ(SINGTYPE_INTMAT, im))) {
-        ErrorQuit("im must be a singular intmat", 0L, 0L);
+        _SI_ErrorQuit("im must be a singular intmat", 0L, 0L);
         return Fail;
     }
     intvec *i = (intvec *)CXX_SINGOBJ(im);
@@ -157,42 +159,41 @@ Obj Func_SI_matrix_from_els(Obj self, Obj nrrows, Obj nrcols, Obj l)
 {
     if (!(IS_INTOBJ(nrrows) && IS_INTOBJ(nrcols) &&
           INT_INTOBJ(nrrows) > 0 && INT_INTOBJ(nrcols) > 0)) {
-        ErrorQuit("nrrows and nrcols must be positive integers", 0L, 0L);
+        _SI_ErrorQuit("nrrows and nrcols must be positive integers", 0L, 0L);
         return Fail;
     }
     Int c_nrrows = INT_INTOBJ(nrrows);
     Int c_nrcols = INT_INTOBJ(nrcols);
     if (!IS_LIST(l)) {
-        ErrorQuit("l must be a list", 0L, 0L);
+        _SI_ErrorQuit("l must be a list", 0L, 0L);
         return Fail;
     }
     Int len = LEN_LIST(l);
     if (len == 0) {
-        ErrorQuit("l must contain at least one element", 0L, 0L);
+        _SI_ErrorQuit("l must contain at least one element", 0L, 0L);
         return Fail;
     }
-    matrix mat;
+    CleanupScope scope;
+    matrix mat = NULL;
     Int i;
     Obj t = NULL;
     ring r = NULL;
     Int row = 1;
     Int col = 1;
     for (i = 1; i <= len && row <= c_nrrows; i++) {
-        t = ELM_LIST(l, i);
-        if (!(ISSINGOBJ(SINGTYPE_POLY, t) || ISSINGOBJ(SINGTYPE_POLY_IMM, t))) {
-            if (i > 1)
-                id_Delete((ideal *) &mat, r);
-            ErrorQuit("l must only contain singular polynomials", 0L, 0L);
+        t = ELM0_LIST(l, i);
+        if (t == 0 || !(ISSINGOBJ(SINGTYPE_POLY, t) || ISSINGOBJ(SINGTYPE_POLY_IMM, t))) {
+            _SI_ErrorQuit("l must only contain singular polynomials", 0L, 0L);
             return Fail;
         }
         if (i == 1) {
             r = CXXRING_SINGOBJ(t);
             if (r != currRing) rChangeCurrRing(r);
             mat = mpNew(c_nrrows, c_nrcols);
+            _SI_AddCleanupIdeal((ideal *) &mat, r);
         } else {
             if (r != CXXRING_SINGOBJ(t)) {
-                id_Delete((ideal *) &mat, r);
-                ErrorQuit("all elements of l must have the same ring", 0L, 0L);
+                _SI_ErrorQuit("all elements of l must have the same ring", 0L, 0L);
                 return Fail;
             }
         }
@@ -224,7 +225,7 @@ Obj Func_SI_MatElm(Obj self, Obj obj, Obj row_, Obj col_)
             bigintmat *mat = (bigintmat *)data;
             if (row <= 0 || row > mat->rows() ||
                 col <= 0 || col > mat->cols()) {
-                ErrorQuit("bigintmat indices out of range", 0L, 0L);
+                _SI_ErrorQuit("bigintmat indices out of range", 0L, 0L);
             }
             number n = BIMATELEM(*mat, row, col);
             return _SI_BIGINT_OR_INT_TO_GAP(n);
@@ -235,7 +236,7 @@ Obj Func_SI_MatElm(Obj self, Obj obj, Obj row_, Obj col_)
             intvec *mat = (intvec *)data;
             if (row <= 0 || row > mat->rows() ||
                 col <= 0 || col > mat->cols()) {
-                ErrorQuit("intmat indices out of range", 0L, 0L);
+                _SI_ErrorQuit("intmat indices out of range", 0L, 0L);
             }
             return ObjInt_Int(IMATELEM(*mat, row, col));
             }
@@ -246,7 +247,7 @@ Obj Func_SI_MatElm(Obj self, Obj obj, Obj row_, Obj col_)
             matrix mat = (matrix)data;
             if (row <= 0 || row > mat->nrows ||
                 col <= 0 || col > mat->ncols) {
-                ErrorQuit("matrix indices out of range", 0L, 0L);
+                _SI_ErrorQuit("matrix indices out of range", 0L, 0L);
             }
             poly p = MATELEM(mat, row, col);
             p = p_Copy(p, r);
@@ -254,7 +255,7 @@ Obj Func_SI_MatElm(Obj self, Obj obj, Obj row_, Obj col_)
             }
 
         default:
-            ErrorQuit("<obj> is not a matrix", 0L, 0L);
+            _SI_ErrorQuit("<obj> is not a matrix", 0L, 0L);
             break;
     }
     return Fail;
@@ -265,21 +266,22 @@ Obj Func_SI_MatElm(Obj self, Obj obj, Obj row_, Obj col_)
 Obj Func_SI_SetMatElm(Obj self, Obj obj, Obj row_, Obj col_, Obj val)
 {
     UInt gtype = TYPE_SINGOBJ(obj);
-    void *data = CXX_SINGOBJ(obj);
 
     int row = INT_INTOBJ(row_);
     int col = INT_INTOBJ(col_);
 
     if (!IS_MUTABLE_OBJ(obj)) {
-        ErrorQuit("Cannot assign to immutable matrix.", 0L, 0L);
+        _SI_ErrorQuit("Cannot assign to immutable matrix.", 0L, 0L);
     }
+    _SI_UnshareSingObj(obj);
+    void *data = CXX_SINGOBJ(obj);
     switch (gtype) {
         case SINGTYPE_BIGINTMAT:
         case SINGTYPE_BIGINTMAT_IMM: {
             bigintmat *mat = (bigintmat *)data;
             if (row <= 0 || row > mat->rows() ||
                 col <= 0 || col > mat->cols()) {
-                ErrorQuit("bigintmat indices out of range", 0L, 0L);
+                _SI_ErrorQuit("bigintmat indices out of range", 0L, 0L);
             }
             number n;
             if (ISSINGOBJ(SINGTYPE_BIGINT, val) || ISSINGOBJ(SINGTYPE_BIGINT_IMM, val)) {
@@ -298,10 +300,10 @@ Obj Func_SI_SetMatElm(Obj self, Obj obj, Obj row_, Obj col_, Obj val)
             intvec *mat = (intvec *)data;
             if (row <= 0 || row > mat->rows() ||
                 col <= 0 || col > mat->cols()) {
-                ErrorQuit("intmat indices out of range", 0L, 0L);
+                _SI_ErrorQuit("intmat indices out of range", 0L, 0L);
             }
             if (!IS_INTOBJ(val))
-                ErrorQuit("<val> must be an integer.\n", 0L, 0L);
+                _SI_ErrorQuit("<val> must be an integer.\n", 0L, 0L);
             IMATELEM(*mat, row, col) = INT_INTOBJ(val);
             }
             break;
@@ -312,21 +314,25 @@ Obj Func_SI_SetMatElm(Obj self, Obj obj, Obj row_, Obj col_, Obj val)
             matrix mat = (matrix)data;
             if (row <= 0 || row > mat->nrows ||
                 col <= 0 || col > mat->ncols) {
-                ErrorQuit("matrix indices out of range", 0L, 0L);
+                _SI_ErrorQuit("matrix indices out of range", 0L, 0L);
             }
             if (!(ISSINGOBJ(SINGTYPE_POLY, val) || ISSINGOBJ(SINGTYPE_POLY_IMM, val)))
-                ErrorQuit("<val> must be a polynomial.\n", 0L, 0L);
+                _SI_ErrorQuit("<val> must be a polynomial.\n", 0L, 0L);
             if (r != CXXRING_SINGOBJ(val))
-                ErrorQuit("<obj> and <val> must be defined over same ring.\n", 0L, 0L);
+                _SI_ErrorQuit("<obj> and <val> must be defined over same ring.\n", 0L, 0L);
 
+            UInt bytes = BYTES_SINGOBJ(obj);
+            UInt oldbytes = _SI_ByteSizeOfPoly(MATELEM(mat, row, col), r);
+            bytes = (bytes > oldbytes) ? bytes - oldbytes : 0;
             pDelete(&MATELEM(mat, row, col));
             poly p = (poly)CXX_SINGOBJ(val);
             MATELEM(mat, row, col) = p_Copy(p, r);
+            _SI_SetWrapperBytes(obj, bytes + BYTES_SINGOBJ(val));
             }
             break;
 
         default:
-            ErrorQuit("<obj> is not a matrix", 0L, 0L);
+            _SI_ErrorQuit("<obj> is not a matrix", 0L, 0L);
             break;
     }
     return 0;
@@ -0,0 +1,356 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "memo.h"
+#include "hash.h"
+#include "cleanup.h"
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+//////////////// Memoizing pure Singular operations ////////////////////
+
+// If enabled via SI_SetMemoLimit, the results of deterministic Singular
+// commands and of library procedures declared pure via SI_MemoizeProcs
+// are remembered. A call is looked up by the operation, the current
+// ring, the global Singular options and the arguments, which are
+// compared structurally: two different but equal ideals are the same
+// key. Only calls whose arguments are immutable Singular objects
+// without attributes, small integers or strings are memoized.
+//
+// The table is bounded by the estimated size of the remembered results
+// and arguments; once that exceeds the limit, the least recently used
+// entries are dropped.
+//
+// The GAP objects of an entry are kept in the plain list MemoEntries,
+// as [ key, value ] with key = [ op, ring wrapper or 0, args... ], so
+// that GASMAN sees them. Everything else is kept on the C++ side.
+
+// Commands without side effects whose result only depends on their
+// arguments and the global options (see SingularOptions).
+static const int MemoCommands[] = {
+    STD_CMD,
+    SYZYGY_CMD,
+    FAC_CMD,
+    DIM_CMD,
+    MULTIPLICITY_CMD,
+    VDIM_CMD,
+    HILBERT_CMD,
+    KBASE_CMD,
+    REDUCE_CMD,
+    ELIMINATION_CMD,
+};
+
+struct MemoEntry {
+    UInt hash;
+    UInt bytes;
+    SingularOptions opts;   // the options when the result was computed
+    std::list<UInt>::iterator lru;
+};
+
+static Obj MemoEntries;
+static std::vector<MemoEntry> MemoMeta;      // indexed by slot - 1
+static std::multimap<UInt, UInt> MemoIndex;  // hash -> slot
+static std::list<UInt> MemoLRU;              // most recently used first
+static std::vector<UInt> MemoFreeSlots;
+static std::set<std::string> MemoProcs;
+
+static UInt MemoLimit = 0;     // 0 means disabled
+static UInt MemoBytes = 0;
+
+static struct {
+    UInt hits;
+    UInt misses;
+    UInt evictions;
+} MemoCounters;
+
+void _SI_InitMemo(void)
+{
+    InitGlobalBag(&MemoEntries, "src/memo.cc:MemoEntries");
+}
+
+static bool IsMemoOp(Obj op)
+{
+    if (IS_INTOBJ(op)) {
+        int iop = INT_INTOBJ(op);
+        for (UInt i = 0; i < sizeof(MemoCommands) / sizeof(MemoCommands[0]); i++)
+            if (MemoCommands[i] == iop)
+                return true;
+        return false;
+    }
+    return MemoProcs.find(std::string((const char *)CHARS_STRING(op)))
+           != MemoProcs.end();
+}
+
+// Hash value of a memoizable argument, see the comment at the top.
+// Returns false if the argument cannot be memoized.
+static bool HashArg(Obj a, UInt *hash)
+{
+    if (IS_INTOBJ(a)) {
+        *hash = (UInt)a;
+        return true;
+    }
+    if (TNUM_OBJ(a) == T_SINGULAR) {
+        if (IS_MUTABLE_OBJ(a) || ATTRIB_SINGOBJ(a) != NULL)
+            return false;
+        *hash = _SI_HashSingObj(a) + FLAGS_SINGOBJ(a);
+        return true;
+    }
+    if (IS_STRING_REP(a)) {
+        *hash = _SI_Hash(STRING_CMD, CHARS_STRING(a), 0);
+        return true;
+    }
+    return false;
+}
+
+static bool EqualArg(Obj a, Obj b)
+{
+    if (a == b)
+        return true;
+    if (IS_INTOBJ(a) || IS_INTOBJ(b))
+        return false;
+    if (TNUM_OBJ(a) == T_SINGULAR) {
+        return TNUM_OBJ(b) == T_SINGULAR &&
+               FLAGS_SINGOBJ(a) == FLAGS_SINGOBJ(b) &&
+               _SI_EqualSingObj(a, b);
+    }
+    return IS_STRING_REP(b) && EQ(a, b);
+}
+
+//! Decide whether the call of op (a command number or the name of a
+//! procedure) with the given arguments in the ring r is memoized. If
+//! so, returns true and sets *hash to the hash value of the call.
+bool _SI_MemoKey(Obj op, ring r, int nrargs, Obj *args, UInt *hash)
+{
+    if (MemoLimit == 0 || !IsMemoOp(op))
+        return false;
+    // hilb(I) only prints the Hilbert series
+    if (op == INTOBJ_INT(HILBERT_CMD) && (nrargs < 2 || !IS_INTOBJ(args[1])))
+        return false;
+    // The key references the ring through its wrapper, which keeps the
+    // ring alive; rings that were never wrapped are not supported.
+    if (r != NULL && r->ext_ref == NULL)
+        return false;
+    UInt h = IS_INTOBJ(op) ? (UInt)op : _SI_Hash(STRING_CMD, CHARS_STRING(op), 0);
+    h = h * 31 + (UInt)r;
+    for (int i = 0; i < nrargs; i++) {
+        UInt ha;
+        if (!HashArg(args[i], &ha))
+            return false;
+        h = h * 31 + ha;
+    }
+    *hash = h;
+    return true;
+}
+
+static bool KeyMatches(UInt slot, Obj op, ring r, int nrargs, Obj *args)
+{
+    const MemoEntry &e = MemoMeta[slot - 1];
+    if (!e.opts.current())
+        return false;
+    Obj key = ELM_PLIST(ELM_PLIST(MemoEntries, slot), 1);
+    if (LEN_PLIST(key) != nrargs + 2)
+        return false;
+    Obj kop = ELM_PLIST(key, 1);
+    if (IS_INTOBJ(op) ? kop != op : (IS_INTOBJ(kop) || !EQ(kop, op)))
+        return false;
+    Obj kr = ELM_PLIST(key, 2);
+    if ((IS_INTOBJ(kr) ? (ring)0 : (ring)CXX_SINGOBJ(kr)) != r)
+        return false;
+    for (int i = 0; i < nrargs; i++)
+        if (!EqualArg(ELM_PLIST(key, i + 3), args[i]))
+            return false;
+    return true;
+}
+
+//! Look up a memoized call, see _SI_MemoKey. Returns NULL if there is
+//! none. Like a freshly computed result, a Singular object is returned
+//! as a mutable (shallow) copy.
+Obj _SI_MemoLookup(Obj op, ring r, int nrargs, Obj *args, UInt hash)
+{
+    std::pair<std::multimap<UInt, UInt>::iterator,
+              std::multimap<UInt, UInt>::iterator> range
+        = MemoIndex.equal_range(hash);
+    for (std::multimap<UInt, UInt>::iterator it = range.first;
+         it != range.second; ++it) {
+        UInt slot = it->second;
+        if (!KeyMatches(slot, op, r, nrargs, args))
+            continue;
+        MemoCounters.hits++;
+        MemoEntry &e = MemoMeta[slot - 1];
+        MemoLRU.splice(MemoLRU.begin(), MemoLRU, e.lru);
+        Obj res = ELM_PLIST(ELM_PLIST(MemoEntries, slot), 2);
+        if (TNUM_OBJ(res) == T_SINGULAR)
+            res = ShallowCopyObjSingular(res);
+        return res;
+    }
+    MemoCounters.misses++;
+    return NULL;
+}
+
+static void DropEntry(UInt slot)
+{
+    MemoEntry &e = MemoMeta[slot - 1];
+    std::pair<std::multimap<UInt, UInt>::iterator,
+              std::multimap<UInt, UInt>::iterator> range
+        = MemoIndex.equal_range(e.hash);
+    for (std::multimap<UInt, UInt>::iterator it = range.first;
+         it != range.second; ++it) {
+        if (it->second == slot) {
+            MemoIndex.erase(it);
+            break;
+        }
+    }
+    MemoLRU.erase(e.lru);
+    MemoBytes -= e.bytes;
+    SET_ELM_PLIST(MemoEntries, slot, 0);
+    MemoFreeSlots.push_back(slot);
+}
+
+static void ShrinkMemo(UInt limit)
+{
+    while (MemoBytes > limit && !MemoLRU.empty()) {
+        DropEntry(MemoLRU.back());
+        MemoCounters.evictions++;
+    }
+}
+
+//! Remember the result of a call, see _SI_MemoKey.
+void _SI_MemoStore(Obj op, ring r, int nrargs, Obj *args, UInt hash, Obj res)
+{
+    if (res == Fail || res == SI_MemoryLimitExceeded)
+        return;
+    if (TNUM_OBJ(res) != T_SINGULAR && IS_MUTABLE_OBJ(res))
+        return;
+
+    UInt bytes = sizeof(MemoEntry) + (nrargs + 4) * sizeof(Obj);
+    if (TNUM_OBJ(res) == T_SINGULAR) {
+        bytes += BYTES_SINGOBJ(res);
+        res = CopyObjSingular(res, 0);
+    }
+
+    Obj key = NEW_PLIST(T_PLIST, nrargs + 2);
+    SET_LEN_PLIST(key, nrargs + 2);
+    SET_ELM_PLIST(key, 1, IS_INTOBJ(op) ? op : CopyObj(op, 0));
+    SET_ELM_PLIST(key, 2, r ? (Obj)r->ext_ref : INTOBJ_INT(0));
+    for (int i = 0; i < nrargs; i++) {
+        Obj a = args[i];
+        if (TNUM_OBJ(a) == T_SINGULAR)
+            bytes += BYTES_SINGOBJ(a);
+        else if (!IS_INTOBJ(a))
+            a = CopyObj(a, 0);
+        SET_ELM_PLIST(key, i + 3, a);
+        CHANGED_BAG(key);
+    }
+    if (bytes > MemoLimit)
+        return;
+
+    Obj entry = NEW_PLIST(T_PLIST, 2);
+    SET_LEN_PLIST(entry, 2);
+    SET_ELM_PLIST(entry, 1, key);
+    SET_ELM_PLIST(entry, 2, res);
+    CHANGED_BAG(entry);
+
+    ShrinkMemo(MemoLimit - bytes);
+
+    if (MemoEntries == 0)
+        MemoEntries = NEW_PLIST(T_PLIST, 0);
+    UInt slot;
+    if (MemoFreeSlots.empty()) {
+        MemoMeta.push_back(MemoEntry());
+        slot = MemoMeta.size();
+    } else {
+        slot = MemoFreeSlots.back();
+        MemoFreeSlots.pop_back();
+    }
+    AssPlist(MemoEntries, slot, entry);
+
+    MemoEntry &e = MemoMeta[slot - 1];
+    e.hash = hash;
+    e.bytes = bytes;
+    e.opts.get();
+    MemoLRU.push_front(slot);
+    e.lru = MemoLRU.begin();
+    MemoIndex.insert(std::make_pair(hash, slot));
+    MemoBytes += bytes;
+}
+
+//! Drop the memoized results of all procs. Their keys only contain the
+//! name of the proc, so this is called whenever procs may have been
+//! redefined, see _SI_InvalidateProcHandles.
+void _SI_MemoForgetProcs(void)
+{
+    if (MemoProcs.empty() || MemoLRU.empty())
+        return;
+    std::vector<UInt> slots;
+    for (std::list<UInt>::iterator it = MemoLRU.begin(); it != MemoLRU.end(); ++it) {
+        Obj key = ELM_PLIST(ELM_PLIST(MemoEntries, *it), 1);
+        if (!IS_INTOBJ(ELM_PLIST(key, 1)))
+            slots.push_back(*it);
+    }
+    for (UInt i = 0; i < slots.size(); i++)
+        DropEntry(slots[i]);
+}
+
+//! Set the maximal estimated number of bytes of the memo table. The
+//! limit 0, which is the default, disables memoization and clears the
+//! table.
+Obj FuncSI_SetMemoLimit(Obj self, Obj limit)
+{
+    if (!IS_INTOBJ(limit) || INT_INTOBJ(limit) < 0)
+        _SI_ErrorQuit("SI_SetMemoLimit: argument must be a non-negative integer", 0L, 0L);
+    MemoLimit = INT_INTOBJ(limit);
+    ShrinkMemo(MemoLimit);
+    return 0;
+}
+
+//! Declare Singular procedures as pure, so that their results can be
+//! memoized. The argument is a list of procedure names.
+Obj FuncSI_MemoizeProcs(Obj self, Obj names)
+{
+    if (!IS_LIST(names))
+        _SI_ErrorQuit("SI_MemoizeProcs: argument must be a list of strings", 0L, 0L);
+    Int len = LEN_LIST(names);
+    for (Int i = 1; i <= len; i++) {
+        Obj name = ELM0_LIST(names, i);
+        if (name == 0 || !IsStringConv(name))
+            _SI_ErrorQuit("SI_MemoizeProcs: argument must be a list of strings", 0L, 0L);
+        MemoProcs.insert(std::string((const char *)CHARS_STRING(name)));
+    }
+    return 0;
+}
+
+//! Return a record with statistics about the memo table.
+Obj FuncSI_MemoStats(Obj self)
+{
+    Obj res = NEW_PREC(0);
+    AssPRec(res, RNamName("limit"), ObjInt_UInt(MemoLimit));
+    AssPRec(res, RNamName("bytes"), ObjInt_UInt(MemoBytes));
+    AssPRec(res, RNamName("entries"), ObjInt_UInt(MemoLRU.size()));
+    AssPRec(res, RNamName("hits"), ObjInt_UInt(MemoCounters.hits));
+    AssPRec(res, RNamName("misses"), ObjInt_UInt(MemoCounters.misses));
+    AssPRec(res, RNamName("evictions"), ObjInt_UInt(MemoCounters.evictions));
+    return res;
+}
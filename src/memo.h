@@ -0,0 +1,38 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef LIBSING_MEMO_H
+#define LIBSING_MEMO_H
+
+#include "libsing.h"
+
+void _SI_InitMemo(void);
+
+bool _SI_MemoKey(Obj op, ring r, int nrargs, Obj *args, UInt *hash);
+Obj _SI_MemoLookup(Obj op, ring r, int nrargs, Obj *args, UInt hash);
+void _SI_MemoStore(Obj op, ring r, int nrargs, Obj *args, UInt hash, Obj res);
+void _SI_MemoForgetProcs(void);
+
+Obj FuncSI_SetMemoLimit(Obj self, Obj limit);
+Obj FuncSI_MemoizeProcs(Obj self, Obj names);
+Obj FuncSI_MemoStats(Obj self);
+
+#endif
@@ -0,0 +1,720 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "memory.h"
+#include "accumulator.h"
+#include "cleanup.h"
+
+#include <coeffs/bigintmat.h>
+#include <coeffs/longrat.h>
+#include <Singular/lists.h>
+#include <Singular/cntrlc.h>    // for siCntrlc
+
+#include <signal.h>
+#include <sys/time.h>
+
+#include <deque>
+#include <map>
+
+
+//////////////// Estimating the size of Singular objects /////////////////
+
+// Our estimates only count the memory which is directly owned by an
+// object. They do not walk into the ring, and they ignore the
+// bookkeeping overhead of omalloc.
+
+// Size of a single number over the coefficient domain cf.
+static UInt NumberByteSize(number n, const coeffs cf)
+{
+    if (n == NULL)
+        return 0;
+    if (nCoeff_is_Q(cf)) {
+        // Small rationals are immediate and take no extra memory.
+        if (SR_HDL(n) & SR_INT)
+            return 0;
+        UInt size = sizeof(*n) + mpz_size(n->z) * sizeof(mp_limb_t);
+        if (n->s != 3)    // not an integer, so there is a denominator
+            size += mpz_size(n->n) * sizeof(mp_limb_t);
+        return size;
+    }
+    if (nCoeff_is_Zp(cf))
+        return 0;
+    // For all other coefficient domains, we just make a rough guess.
+    return 4 * sizeof(void *);
+}
+
+//! Estimate the number of bytes used by a polynomial or vector.
+UInt _SI_ByteSizeOfPoly(poly p, ring r)
+{
+    const UInt monomsize = omSizeWOfBin(r->PolyBin) * sizeof(long);
+    UInt size = 0;
+    while (p != NULL) {
+        size += monomsize + NumberByteSize(pGetCoeff(p), r->cf);
+        pIter(p);
+    }
+    return size;
+}
+
+// Size of the generators of an ideal, module or matrix, which all
+// consist of an array of n polynomials.
+static UInt PolyArrayByteSize(poly *m, int n, ring r)
+{
+    UInt size = n * sizeof(poly);
+    for (int i = 0; i < n; i++)
+        size += _SI_ByteSizeOfPoly(m[i], r);
+    return size;
+}
+
+//! Estimate the number of bytes used by a Singular object of type
+//! rtyp with the given data. For ring dependent objects, r must be
+//! the base ring.
+UInt _SI_ByteSize(int rtyp, void *data, ring r)
+{
+    if (data == NULL)
+        return 0;
+    switch (rtyp) {
+        case POLY_CMD:
+        case VECTOR_CMD:
+            return _SI_ByteSizeOfPoly((poly)data, r);
+        case IDEAL_CMD:
+        case MODUL_CMD:
+        case MAP_CMD: {
+            ideal id = (ideal)data;
+            return sizeof(*id) + PolyArrayByteSize(id->m, IDELEMS(id), r);
+        }
+        case MATRIX_CMD: {
+            matrix mat = (matrix)data;
+            return sizeof(*mat) + PolyArrayByteSize(mat->m,
+                                        MATROWS(mat) * MATCOLS(mat), r);
+        }
+        case NUMBER_CMD:
+            return NumberByteSize((number)data, r->cf);
+        case BIGINT_CMD:
+            return NumberByteSize((number)data, coeffs_BIGINT);
+        case INTVEC_CMD:
+        case INTMAT_CMD: {
+            intvec *iv = (intvec *)data;
+            return sizeof(*iv) + iv->length() * sizeof(int);
+        }
+        case BIGINTMAT_CMD: {
+            bigintmat *bim = (bigintmat *)data;
+            UInt size = sizeof(*bim) + bim->rows() * bim->cols() * sizeof(number);
+            for (int i = 1; i <= bim->rows(); i++)
+                for (int j = 1; j <= bim->cols(); j++)
+                    size += NumberByteSize(bim->view(i, j), bim->basecoeffs());
+            return size;
+        }
+        case STRING_CMD:
+            return strlen((char *)data) + 1;
+        case LIST_CMD: {
+            lists l = (lists)data;
+            UInt size = sizeof(*l) + (l->nr + 1) * sizeof(sleftv);
+            for (int i = 0; i <= l->nr; i++)
+                size += _SI_ByteSize(l->m[i].Typ(), l->m[i].Data(), r);
+            return size;
+        }
+        case RING_CMD:
+        case QRING_CMD: {
+            ring rr = (ring)data;
+            UInt size = sizeof(*rr) + rr->N * (sizeof(char *) + 2 * sizeof(int));
+            if (rr->qideal != NULL)
+                size += _SI_ByteSize(IDEAL_CMD, rr->qideal, rr);
+            return size;
+        }
+        default:
+            // Resolutions, links, ...: we do not know better.
+            return sizeof(sleftv);
+    }
+}
+
+// Quick estimate for a polynomial: its terms are counted, and all
+// coefficients are assumed to be as large as the leading one.
+static UInt QuickByteSizeOfPoly(poly p, ring r)
+{
+    if (p == NULL)
+        return 0;
+    const UInt monomsize = omSizeWOfBin(r->PolyBin) * sizeof(long);
+    return pLength(p) * (monomsize + NumberByteSize(pGetCoeff(p), r->cf));
+}
+
+static UInt QuickPolyArrayByteSize(poly *m, int n, ring r)
+{
+    UInt size = n * sizeof(poly);
+    for (int i = 0; i < n; i++)
+        size += QuickByteSizeOfPoly(m[i], r);
+    return size;
+}
+
+//! A cheaper variant of _SI_ByteSize, which is used whenever a wrapper
+//! is created or its object modified in place: polynomials are only
+//! walked to count their terms, and the entries of lists are ignored.
+//! SI_ByteSize replaces this by the estimate of _SI_ByteSize.
+UInt _SI_QuickByteSize(int rtyp, void *data, ring r)
+{
+    if (data == NULL)
+        return 0;
+    switch (rtyp) {
+        case POLY_CMD:
+        case VECTOR_CMD:
+            return QuickByteSizeOfPoly((poly)data, r);
+        case IDEAL_CMD:
+        case MODUL_CMD:
+        case MAP_CMD: {
+            ideal id = (ideal)data;
+            return sizeof(*id) + QuickPolyArrayByteSize(id->m, IDELEMS(id), r);
+        }
+        case MATRIX_CMD: {
+            matrix mat = (matrix)data;
+            return sizeof(*mat) + QuickPolyArrayByteSize(mat->m,
+                                        MATROWS(mat) * MATCOLS(mat), r);
+        }
+        case BIGINTMAT_CMD: {
+            bigintmat *bim = (bigintmat *)data;
+            return sizeof(*bim) + bim->rows() * bim->cols() * sizeof(number);
+        }
+        case LIST_CMD: {
+            lists l = (lists)data;
+            return sizeof(*l) + (l->nr + 1) * sizeof(sleftv);
+        }
+        default:
+            return _SI_ByteSize(rtyp, data, r);
+    }
+}
+
+
+// The queue of objects waiting to be freed, see _SI_QueueFree below.
+struct PendingFree {
+    void *data;
+    int rtyp;
+    BITSET flag;
+    attr attribute;
+    ring r;
+    UInt bytes;
+};
+
+static std::deque<PendingFree> FreeQueue;
+static UInt FreeBudget = 1000000L;      //!< bytes freed per step, 0 = all
+static UInt PendingBytes = 0;           //!< bytes in the queue
+
+
+//////////////// Triggering garbage collections /////////////////
+
+// Every wrapper records how many bytes its Singular object uses
+// (see BYTES_SINGOBJ). Based on this, we trigger a partial collection
+// by GASMAN once enough bytes were wrapped since the last collection,
+// because most wrappers die young. Every GCFullRatio-th collection, or
+// once the bytes held by all live wrappers exceed a threshold, we do a
+// full collection instead. After a full collection, that threshold is
+// reset to twice the surviving bytes (but at least GCFullBytes).
+
+static UInt GCYoungBytes = 1000000L;    //!< bytes wrapped before a partial GC
+static UInt GCFullBytes = 4000000L;     //!< minimal threshold for a full GC
+static UInt GCFullRatio = 10;           //!< every nth GC is a full one
+
+static UInt GCFullThreshold = 4000000L;
+static UInt BytesSinceGC = 0;           //!< bytes wrapped since the last GC
+static UInt GCCount = 0;                //!< partial GCs since the last full one
+
+// Counters for SI_GCStats, reset by SI_ResetGCStats.
+static struct {
+    UInt forcedPartial;     //!< partial GCs triggered by _SI_NoteNewWrapper
+    UInt forcedFull;        //!< full GCs triggered by _SI_NoteNewWrapper
+    UInt collections;       //!< all GCs, including those started by GASMAN
+    UInt ringsQueued;       //!< rings passed to AddSingularRingToCleanup
+    UInt ringsKilled;       //!< rings released by SingularRingCleaner
+    UInt freedByType[SINGTYPE_LASTNUMBER + 1];  //!< wrappers freed, by type
+    UInt freeSteps;         //!< calls of _SI_FreeStep which freed something
+    UInt objectsFreed;      //!< Singular objects freed by _SI_FreeStep
+    UInt bytesFreed;        //!< their bytes
+    UInt freeMicroseconds;  //!< time spent in _SI_FreeStep
+} GCCounters;
+
+// Statistics about live wrappers: their number, the bytes used by
+// their Singular objects, and the maximal number of bytes since the
+// last call of SI_ResetMemoryStats. We keep these in total, by GAP
+// type and by ring (for ring dependent objects). Since wrappers can
+// become immutable, the mutable and immutable variant of a type (which
+// only differ in the lowest bit) share their entry. The entry of a
+// ring is removed when the ring wrapper dies.
+struct MemStats {
+    UInt count;
+    UInt bytes;
+    UInt peak;
+};
+
+static MemStats TotalStats;
+static MemStats TypeStats[SINGTYPE_LASTNUMBER + 1];
+static std::map<ring, MemStats> RingStats;
+
+static void AddToStats(MemStats &st, UInt bytes)
+{
+    st.count++;
+    st.bytes += bytes;
+    if (st.bytes > st.peak)
+        st.peak = st.bytes;
+}
+
+static void SubFromStats(MemStats &st, UInt bytes)
+{
+    if (st.count > 0)
+        st.count--;
+    st.bytes = (bytes > st.bytes) ? 0 : st.bytes - bytes;
+}
+
+static void AddWrapper(UInt gtype, ring r, UInt bytes)
+{
+    AddToStats(TotalStats, bytes);
+    AddToStats(TypeStats[gtype & ~1], bytes);
+    if (r != NULL)
+        AddToStats(RingStats[r], bytes);
+}
+
+//! Called whenever a new wrapper of GAP type gtype for an object using
+//! the given number of bytes is about to be created. For ring dependent
+//! objects, r is their ring, otherwise NULL. May trigger a garbage
+//! collection.
+void _SI_NoteNewWrapper(UInt gtype, ring r, UInt bytes)
+{
+    BytesSinceGC += bytes;
+    if (BytesSinceGC > GCYoungBytes) {
+        if (TotalStats.bytes > GCFullThreshold || GCCount + 1 >= GCFullRatio) {
+            GCCounters.forcedFull++;
+            CollectBags(0, 1);
+            GCCount = 0;
+            GCFullThreshold = 2 * TotalStats.bytes;
+            if (GCFullThreshold < GCFullBytes)
+                GCFullThreshold = GCFullBytes;
+        } else {
+            GCCounters.forcedPartial++;
+            CollectBags(0, 0);
+            GCCount++;
+        }
+    }
+    AddWrapper(gtype, r, bytes);
+    if (!FreeQueue.empty())
+        _SI_FreeStep(bytes);
+}
+
+static void RemoveWrapper(UInt gtype, ring r, UInt bytes)
+{
+    SubFromStats(TotalStats, bytes);
+    SubFromStats(TypeStats[gtype & ~1], bytes);
+    if (r != NULL) {
+        std::map<ring, MemStats>::iterator it = RingStats.find(r);
+        if (it != RingStats.end())
+            SubFromStats(it->second, bytes);
+    }
+}
+
+//! Called by the free function of a wrapper, with the same arguments
+//! as _SI_NoteNewWrapper (and the bytes it recorded).
+void _SI_NoteFreedWrapper(UInt gtype, ring r, UInt bytes)
+{
+    GCCounters.freedByType[gtype & ~1]++;
+    RemoveWrapper(gtype, r, bytes);
+}
+
+//! Called by the free function of a ring wrapper.
+void _SI_ForgetRingStats(ring r)
+{
+    RingStats.erase(r);
+}
+
+//! Record that the Singular object inside the wrapper obj was modified
+//! in place and now uses the given number of bytes.
+void _SI_SetWrapperBytes(Obj obj, UInt bytes)
+{
+    UInt gtype = TYPE_SINGOBJ(obj);
+    ring r = HasRingTable[gtype] ? CXXRING_SINGOBJ(obj) : NULL;
+    RemoveWrapper(gtype, r, BYTES_SINGOBJ(obj));
+    AddWrapper(gtype, r, bytes);
+    SET_BYTES_SINGOBJ(obj, bytes);
+}
+
+//! Called after each garbage collection, including those that GASMAN
+//! started on its own.
+void _SI_NoteCollection(void)
+{
+    GCCounters.collections++;
+    BytesSinceGC = 0;
+}
+
+//! Called when a ring wrapper died and its ring was queued for killing.
+void _SI_NoteRingQueued(void)
+{
+    GCCounters.ringsQueued++;
+}
+
+//! Called when SingularRingCleaner released a queued ring.
+void _SI_NoteRingKilled(void)
+{
+    GCCounters.ringsKilled++;
+}
+
+static UInt Microseconds(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (UInt)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+//////////////// Deferred freeing of Singular objects /////////////////
+
+// Freeing a big Singular object means walking all its monomials. To
+// keep GASMAN's pauses short, _SI_FreeFunc does not free the objects
+// of dead wrappers right away, but puts them into a queue. That queue
+// is drained in steps after each garbage collection and whenever a new
+// wrapper is created; each step frees at most FreeBudget bytes (but
+// always at least one object, and at least as many bytes as were just
+// wrapped, so that the queue cannot grow without bounds).
+//
+// Every queued object holds a reference to its ring, which is only
+// released by rKill once the object was freed. So rings are killed only
+// after all their dependent objects, no matter in which order they are
+// released.
+
+//! Queue a Singular object for freeing. The arguments correspond to the
+//! members of a sleftv; r is its ring, or NULL.
+void _SI_QueueFree(int rtyp, void *data, BITSET flag, attr a, ring r, UInt bytes)
+{
+    PendingFree f;
+    f.data = data;
+    f.rtyp = rtyp;
+    f.flag = flag;
+    f.attribute = a;
+    f.r = r;
+    f.bytes = bytes;
+    if (r)
+        r->ref++;
+    FreeQueue.push_back(f);
+    PendingBytes += bytes;
+}
+
+//! Free queued objects, worth at least the given number of bytes or
+//! the per step budget, whichever is larger.
+void _SI_FreeStep(UInt wanted)
+{
+    if (FreeQueue.empty())
+        return;
+    UInt start = Microseconds();
+    UInt budget = (FreeBudget == 0 || wanted > FreeBudget) ? wanted : FreeBudget;
+    UInt freed = 0;
+    while (!FreeQueue.empty() && (FreeBudget == 0 || freed <= budget)) {
+        PendingFree f = FreeQueue.front();
+        FreeQueue.pop_front();
+        PendingBytes -= f.bytes;
+        // Count a fixed overhead per object, so that many tiny objects
+        // are not freed in a single step either.
+        freed += f.bytes + sizeof(sleftv);
+        GCCounters.objectsFreed++;
+        GCCounters.bytesFreed += f.bytes;
+
+        sleftv obj;
+        obj.Init();
+        obj.data = f.data;
+        obj.rtyp = f.rtyp;
+        obj.flag = f.flag;
+        obj.attribute = f.attribute;
+        obj.CleanUp(f.r);
+        if (f.r)
+            rKill(f.r);     // drop our reference
+    }
+    GCCounters.freeSteps++;
+    GCCounters.freeMicroseconds += Microseconds() - start;
+}
+
+static UInt GetPolicyEntry(Obj policy, const char *name, UInt old)
+{
+    UInt rnam = RNamName(name);
+    if (!IsbPRec(policy, rnam))
+        return old;
+    Obj val = ElmPRec(policy, rnam);
+    if (!IS_INTOBJ(val) || INT_INTOBJ(val) < 0)
+        _SI_ErrorQuit("SI_SetGCPolicy: component %s must be a non-negative integer",
+                  (Int)name, 0L);
+    return INT_INTOBJ(val);
+}
+
+//! Change the parameters of the garbage collection policy. The argument
+//! is a record, whose components "young", "full", "fullratio" and
+//! "freebudget" set the respective parameter, see above. Missing
+//! components are not changed.
+Obj FuncSI_SetGCPolicy(Obj self, Obj policy)
+{
+    if (!IS_PREC_REP(policy))
+        _SI_ErrorQuit("SI_SetGCPolicy: argument must be a record", 0L, 0L);
+    UInt young = GetPolicyEntry(policy, "young", GCYoungBytes);
+    UInt full = GetPolicyEntry(policy, "full", GCFullBytes);
+    UInt ratio = GetPolicyEntry(policy, "fullratio", GCFullRatio);
+    UInt budget = GetPolicyEntry(policy, "freebudget", FreeBudget);
+    if (ratio == 0)
+        _SI_ErrorQuit("SI_SetGCPolicy: fullratio must be positive", 0L, 0L);
+    GCYoungBytes = young;
+    GCFullBytes = full;
+    GCFullRatio = ratio;
+    FreeBudget = budget;
+    if (GCFullThreshold < GCFullBytes)
+        GCFullThreshold = GCFullBytes;
+    return 0;
+}
+
+//! Return the current parameters of the garbage collection policy as
+//! a record, in the format accepted by SI_SetGCPolicy.
+Obj FuncSI_GCPolicy(Obj self)
+{
+    Obj res = NEW_PREC(4);
+    AssPRec(res, RNamName("young"), ObjInt_UInt(GCYoungBytes));
+    AssPRec(res, RNamName("full"), ObjInt_UInt(GCFullBytes));
+    AssPRec(res, RNamName("fullratio"), ObjInt_UInt(GCFullRatio));
+    AssPRec(res, RNamName("freebudget"), ObjInt_UInt(FreeBudget));
+    return res;
+}
+
+
+//////////////// Memory statistics /////////////////
+
+static Obj StatsToRecord(const MemStats &st)
+{
+    Obj res = NEW_PREC(3);
+    AssPRec(res, RNamName("count"), ObjInt_UInt(st.count));
+    AssPRec(res, RNamName("bytes"), ObjInt_UInt(st.bytes));
+    AssPRec(res, RNamName("peak"), ObjInt_UInt(st.peak));
+    return res;
+}
+
+// The name of the GAP type t in statistics records.
+static const char *TypeName(int t)
+{
+    if ((t & ~1) == SINGTYPE_POLYACC)
+        return "polyaccumulator";
+    return Tok2Cmdname(GAPtoSingType[t]);
+}
+
+//! Return a record with statistics about the live wrapper objects and
+//! the Singular objects inside them. Its component "total" covers all
+//! objects, "types" has one component per Singular type name, and
+//! "rings" is a list with one record per ring (with the ring wrapper in
+//! its component "ring"), covering the objects over that ring. Each of
+//! these records contains the number of wrappers, the estimated bytes
+//! used by them, and the peak of the latter since the last call of
+//! SI_ResetMemoryStats. The component "pending" contains the bytes used
+//! by dead objects that are not yet freed.
+Obj FuncSI_MemoryStats(Obj self)
+{
+    Obj res = NEW_PREC(4);
+    AssPRec(res, RNamName("total"), StatsToRecord(TotalStats));
+
+    Obj types = NEW_PREC(0);
+    for (int t = 0; t <= SINGTYPE_LASTNUMBER; t += 2) {
+        if (TypeStats[t].count == 0 && TypeStats[t].peak == 0)
+            continue;
+        AssPRec(types, RNamName(TypeName(t)),
+                StatsToRecord(TypeStats[t]));
+    }
+    AssPRec(res, RNamName("types"), types);
+
+    Obj rings = NEW_PLIST(T_PLIST, 0);
+    std::map<ring, MemStats>::iterator it;
+    for (it = RingStats.begin(); it != RingStats.end(); ++it) {
+        Obj rr = (Obj)it->first->ext_ref;
+        if (rr == 0)
+            continue;
+        Obj st = StatsToRecord(it->second);
+        AssPRec(st, RNamName("ring"), rr);
+        AddPlist(rings, st);
+    }
+    AssPRec(res, RNamName("rings"), rings);
+
+    AssPRec(res, RNamName("pending"), ObjInt_UInt(PendingBytes));
+    return res;
+}
+
+//! Reset the peaks recorded in the memory statistics to the current
+//! values.
+Obj FuncSI_ResetMemoryStats(Obj self)
+{
+    TotalStats.peak = TotalStats.bytes;
+    for (int t = 0; t <= SINGTYPE_LASTNUMBER; t++)
+        TypeStats[t].peak = TypeStats[t].bytes;
+    std::map<ring, MemStats>::iterator it;
+    for (it = RingStats.begin(); it != RingStats.end(); ++it)
+        it->second.peak = it->second.bytes;
+    return 0;
+}
+
+//! Return the estimated number of bytes used by the Singular object
+//! inside the wrapper obj. As this walks the whole object, it is
+//! also used to refresh the estimate recorded in the wrapper.
+Obj FuncSI_ByteSize(Obj self, Obj obj)
+{
+    if (TNUM_OBJ(obj) != T_SINGULAR)
+        _SI_ErrorQuit("SI_ByteSize: argument must be a Singular object", 0L, 0L);
+    UInt gtype = TYPE_SINGOBJ(obj);
+    ring r;
+    if (gtype == SINGTYPE_RING_IMM || gtype == SINGTYPE_QRING_IMM)
+        r = (ring)CXX_SINGOBJ(obj);
+    else
+        r = HasRingTable[gtype] ? CXXRING_SINGOBJ(obj) : NULL;
+    UInt bytes;
+    if ((gtype & ~1) == SINGTYPE_POLYACC)
+        bytes = _SI_ByteSizeOfAccumulator(CXX_SINGOBJ(obj), r);
+    else
+        bytes = _SI_ByteSize(GAPtoSingType[gtype], CXX_SINGOBJ(obj), r);
+    _SI_SetWrapperBytes(obj, bytes);
+    return ObjInt_UInt(bytes);
+}
+
+
+//////////////// GC statistics /////////////////
+
+//! Return a record with counters describing the interaction of GASMAN
+//! and omalloc since the last call of SI_ResetGCStats, together with
+//! the current thresholds of the GC policy.
+Obj FuncSI_GCStats(Obj self)
+{
+    Obj res = NEW_PREC(0);
+    AssPRec(res, RNamName("forcedpartial"), ObjInt_UInt(GCCounters.forcedPartial));
+    AssPRec(res, RNamName("forcedfull"), ObjInt_UInt(GCCounters.forcedFull));
+    AssPRec(res, RNamName("collections"), ObjInt_UInt(GCCounters.collections));
+    AssPRec(res, RNamName("fullthreshold"), ObjInt_UInt(GCFullThreshold));
+    AssPRec(res, RNamName("bytessincegc"), ObjInt_UInt(BytesSinceGC));
+    AssPRec(res, RNamName("ringsqueued"), ObjInt_UInt(GCCounters.ringsQueued));
+    AssPRec(res, RNamName("ringskilled"), ObjInt_UInt(GCCounters.ringsKilled));
+
+    Obj freed = NEW_PREC(0);
+    for (int t = 0; t <= SINGTYPE_LASTNUMBER; t += 2) {
+        if (GCCounters.freedByType[t] == 0)
+            continue;
+        AssPRec(freed, RNamName(TypeName(t)),
+                ObjInt_UInt(GCCounters.freedByType[t]));
+    }
+    AssPRec(res, RNamName("freedbytype"), freed);
+
+    AssPRec(res, RNamName("freesteps"), ObjInt_UInt(GCCounters.freeSteps));
+    AssPRec(res, RNamName("objectsfreed"), ObjInt_UInt(GCCounters.objectsFreed));
+    AssPRec(res, RNamName("bytesfreed"), ObjInt_UInt(GCCounters.bytesFreed));
+    AssPRec(res, RNamName("freetime"), ObjInt_UInt(GCCounters.freeMicroseconds));
+    return res;
+}
+
+//! Reset all counters reported by SI_GCStats to zero.
+Obj FuncSI_ResetGCStats(Obj self)
+{
+    memset(&GCCounters, 0, sizeof(GCCounters));
+    return 0;
+}
+
+
+//////////////// Memory limit /////////////////
+
+// If a memory limit is set, a virtual interval timer checks how much the
+// memory used by omalloc grew since the start of the current Singular
+// call (see _SI_StartMemoryGuard). Once the growth exceeds the limit, the handler asks Singular to abort the
+// computation by setting siCntrlc, just like an interactive interrupt.
+// Singular checks that flag in its long running loops. The calling
+// function then discards the result and returns SI_MemoryLimitExceeded.
+
+static UInt MemoryLimit = 0;            //!< 0 = no limit
+static volatile sig_atomic_t MemoryLimitHit = 0;
+static UInt MemoryBaseline = 0;         //!< omalloc bytes at call start
+static bool MemoryGuardArmed = false;
+static struct sigaction OldVtalrmAction;
+static struct itimerval OldVirtualTimer;
+
+// interval of the timer, in microseconds of CPU time
+static const long MemoryGuardInterval = 10000;
+
+// omalloc keeps these counters up to date on each allocation from the
+// system, so they are cheap to read, even from a signal handler.
+static UInt OmCurrentBytes(void)
+{
+    return om_Info.CurrentBytesFromValloc + om_Info.CurrentBytesFromMalloc;
+}
+
+static void MemoryGuardHandler(int sig)
+{
+    if (OmCurrentBytes() > MemoryBaseline + MemoryLimit) {
+        MemoryLimitHit = 1;
+        siCntrlc = TRUE;
+    }
+}
+
+//! Called before a Singular call starts.
+void _SI_StartMemoryGuard(void)
+{
+    // A guard still armed was left by an error; disarm it, so that the
+    // saved handler and timer are those from outside of any call.
+    if (MemoryGuardArmed)
+        _SI_StopMemoryGuard();
+    // An interrupt requested by the guard of an aborted call must not
+    // abort this one; one requested by the user must.
+    if (MemoryLimitHit)
+        siCntrlc = FALSE;
+    MemoryLimitHit = 0;
+    if (MemoryLimit == 0)
+        return;
+    MemoryBaseline = OmCurrentBytes();
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = MemoryGuardHandler;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGVTALRM, &act, &OldVtalrmAction);
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = MemoryGuardInterval;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_VIRTUAL, &timer, &OldVirtualTimer);
+    MemoryGuardArmed = true;
+}
+
+//! Called after a Singular call ended. Restores the previous timer and
+//! signal handler, so that we do not interfere with other users of them
+//! outside of Singular calls.
+void _SI_StopMemoryGuard(void)
+{
+    if (!MemoryGuardArmed)
+        return;
+    setitimer(ITIMER_VIRTUAL, &OldVirtualTimer, NULL);
+    sigaction(SIGVTALRM, &OldVtalrmAction, NULL);
+    MemoryGuardArmed = false;
+    if (MemoryLimitHit)
+        siCntrlc = FALSE;
+}
+
+//! Returns true if the memory limit was exceeded during the last
+//! Singular call.
+bool _SI_MemoryLimitHit(void)
+{
+    return MemoryLimitHit;
+}
+
+//! Set a limit on how much the memory used by omalloc may grow during
+//! a Singular call, in bytes; 0 means no limit. Singular calls exceeding it are aborted and return
+//! SI_MemoryLimitExceeded.
+Obj FuncSI_SetMemoryLimit(Obj self, Obj limit)
+{
+    if (!IS_INTOBJ(limit) || INT_INTOBJ(limit) < 0)
+        _SI_ErrorQuit("SI_SetMemoryLimit: argument must be a non-negative integer",
+                  0L, 0L);
+    MemoryLimit = INT_INTOBJ(limit);
+    return 0;
+}
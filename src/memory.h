@@ -0,0 +1,54 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef LIBSING_MEMORY_H
+#define LIBSING_MEMORY_H
+
+#include "libsing.h"
+
+UInt _SI_ByteSize(int rtyp, void *data, ring r);
+UInt _SI_QuickByteSize(int rtyp, void *data, ring r);
+UInt _SI_ByteSizeOfPoly(poly p, ring r);
+
+void _SI_NoteNewWrapper(UInt gtype, ring r, UInt bytes);
+void _SI_NoteFreedWrapper(UInt gtype, ring r, UInt bytes);
+void _SI_ForgetRingStats(ring r);
+void _SI_SetWrapperBytes(Obj obj, UInt bytes);
+void _SI_NoteCollection(void);
+void _SI_NoteRingQueued(void);
+void _SI_NoteRingKilled(void);
+
+void _SI_QueueFree(int rtyp, void *data, BITSET flag, attr a, ring r, UInt bytes);
+void _SI_FreeStep(UInt wanted);
+
+void _SI_StartMemoryGuard(void);
+void _SI_StopMemoryGuard(void);
+bool _SI_MemoryLimitHit(void);
+
+Obj FuncSI_SetGCPolicy(Obj self, Obj policy);
+Obj FuncSI_GCPolicy(Obj self);
+Obj FuncSI_MemoryStats(Obj self);
+Obj FuncSI_ResetMemoryStats(Obj self);
+Obj FuncSI_ByteSize(Obj self, Obj obj);
+Obj FuncSI_GCStats(Obj self);
+Obj FuncSI_ResetGCStats(Obj self);
+Obj FuncSI_SetMemoryLimit(Obj self, Obj limit);
+
+#endif
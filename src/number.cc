@@ -19,6 +19,7 @@
  */
 
 #include "number.h"
+#include "cleanup.h"
 
 
 // The following should be in rational.h but isn't (as of GAP 4.7.2):
@@ -92,7 +93,7 @@ number _SI_NUMBER_FROM_GAP(ring r, Obj n)
         } else if (IS_FFE(n)) {
             FF ff = FLD_FFE(n);
             if (CHAR_FF(ff) != rChar(r) || DEGR_FF(ff) != 1)
-                ErrorQuit("Argument is in wrong field.\n", 0L, 0L);
+                _SI_ErrorQuit("Argument is in wrong field.\n", 0L, 0L);
             Obj v = IntFFE(n);
             return n_Init(INT_INTOBJ(v), r);
         } else if (TNUM_OBJ(n) == T_INTPOS || TNUM_OBJ(n) == T_INTNEG || TNUM_OBJ(n) == T_RAT) {
@@ -101,11 +102,11 @@ number _SI_NUMBER_FROM_GAP(ring r, Obj n)
                 return n_Init(INT_INTOBJ(n) % rChar(r), r);
             }
         }
-        ErrorQuit("Argument must be an integer, rational or finite prime field element.\n", 0L, 0L);
+        _SI_ErrorQuit("Argument must be an integer, rational or finite prime field element.\n", 0L, 0L);
         return NULL;  // never executed
     } else if (!rField_is_Q(r)) {
         // Other fields not yet supported
-        ErrorQuit("GAP numbers over this field not yet implemented.\n", 0L, 0L);
+        _SI_ErrorQuit("GAP numbers over this field not yet implemented.\n", 0L, 0L);
         return NULL;  // never executed
     }
     // Here we know that the rationals are the coefficients:
@@ -149,7 +150,7 @@ number _SI_NUMBER_FROM_GAP(ring r, Obj n)
         }
         return res;
     } else {
-        ErrorQuit("Argument must be an integer or rational.\n", 0L, 0L);
+        _SI_ErrorQuit("Argument must be an integer or rational.\n", 0L, 0L);
         return NULL;  // never executed
     }
 }
@@ -172,7 +173,7 @@ number _SI_BIGINT_FROM_GAP(Obj nr)
         #endif
         n->s = 3;  // indicates an integer
     } else {
-        ErrorQuit("Argument must be an integer.\n", 0L, 0L);
+        _SI_ErrorQuit("Argument must be an integer.\n", 0L, 0L);
     }
     return n;
 }
@@ -207,29 +208,64 @@ int _SI_BIGINT_OR_INT_FROM_GAP(Obj nr, sleftv &obj)
     return SINGTYPE_BIGINT_IMM;
 }
 
+/// Convert a GMP integer into a GAP integer.
+static Obj _SI_GMP_TO_GAP(mpz_t in)
+{
+    Obj res;
+    Int size = in->_mp_size;
+    int sign = size > 0 ? 1 : -1;
+    size = abs(size);
+    if (size == 0)
+        return INTOBJ_INT(0);
+#ifdef SYS_IS_64_BIT
+    if (size == 1) {
+        if (sign > 0)
+            return ObjInt_UInt(in->_mp_d[0]);
+        else
+            return AInvInt(ObjInt_UInt(in->_mp_d[0]));
+    }
+#endif
+    if (sign > 0)
+        res = NewBag(T_INTPOS, sizeof(mp_limb_t) * size);
+    else
+        res = NewBag(T_INTNEG, sizeof(mp_limb_t) * size);
+    memcpy(ADDR_INT(res), in->_mp_d, sizeof(mp_limb_t) * size);
+    return res;
+}
+
 Obj _SI_BIGINT_OR_INT_TO_GAP(number n)
 {
     if (SR_HDL(n) & SR_INT) {
         // an immediate integer
         return INTOBJ_INT(SR_TO_INT(n));
     } else {
-        Obj res;
-        Int size = n->z->_mp_size;
-        int sign = size > 0 ? 1 : -1;
-        size = abs(size);
-#ifdef SYS_IS_64_BIT
-        if (size == 1) {
-            if (sign > 0)
-                return ObjInt_UInt(n->z->_mp_d[0]);
-            else
-                return AInvInt(ObjInt_UInt(n->z->_mp_d[0]));
-        }
-#endif
-        if (sign > 0)
-            res = NewBag(T_INTPOS, sizeof(mp_limb_t) * size);
-        else
-            res = NewBag(T_INTNEG, sizeof(mp_limb_t) * size);
-        memcpy(ADDR_INT(res), n->z->_mp_d, sizeof(mp_limb_t) * size);
-        return res;
+        return _SI_GMP_TO_GAP(n->z);
+    }
+}
+
+/// This internal function converts a coefficient number n of the ring r
+/// into a GAP number. Over the rationals, this yields a GAP integer or
+/// rational; over a prime field, it yields an integer representative.
+Obj _SI_NUMBER_TO_GAP(ring r, number n)
+{
+    if (rField_is_Zp(r)) {
+        return ObjInt_Int(n_Int(n, r->cf));
+    } else if (!rField_is_Q(r)) {
+        // Other fields not yet supported
+        _SI_ErrorQuit("Singular numbers over this field can not yet be converted to GAP.\n", 0L, 0L);
+        return Fail;  // never executed
+    }
+    if (SR_HDL(n) & SR_INT) {
+        // an immediate integer
+        return INTOBJ_INT(SR_TO_INT(n));
+    }
+    if (n->s == 3) {
+        // a long integer
+        return _SI_GMP_TO_GAP(n->z);
     }
+    // A rational number which need not be normalized; GAP takes
+    // care of cancelling common factors for us.
+    Obj num = _SI_GMP_TO_GAP(n->z);
+    Obj den = _SI_GMP_TO_GAP(n->n);
+    return QUO(num, den);
 }
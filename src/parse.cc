@@ -0,0 +1,569 @@
+/* SingularInterface: A GAP interface to Singular
+ *
+ * Copyright (C) 2011-2014  Mohamed Barakat, Max Horn, Frank Lübeck,
+ *                          Oleksandr Motsak, Max Neunhöffer, Hans Schönemann
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+//
+// A small recursive descent parser which turns strings like
+// "x2y+151xyz10+169y21, (x-y)^3" directly into Singular polys,
+// vectors, ideals and matrices, without going through the Singular
+// interpreter. It understands the subset of the Singular language
+// needed to write down polynomial data:
+//
+//   list    := expr { ',' expr }
+//   expr    := term { ('+' | '-') term }
+//   term    := factor { ('*' | '/') factor }
+//   factor  := ('+' | '-') factor | power
+//   power   := primary [ '^' integer ]
+//   primary := number | monomial | '(' expr ')' | '[' list ']'
+//            | 'gen' '(' integer ')'
+//
+// Division is only allowed by nonzero constants. If all ring variables
+// have single letter names, Singular's short syntax like "x2y" or
+// "3xy" is accepted as well.
+//
+// Anything not covered here (interpreter variables, function calls,
+// other coefficient fields, qrings, ...) makes the parser give up; the
+// kernel functions then return fail, and the GAP level falls back to
+// the Singular interpreter. Hence the parser never has to produce
+// error messages of its own.
+//
+
+#include "parse.h"
+#include "cleanup.h"
+
+#include <string>
+
+class SingPolyParser {
+  public:
+    SingPolyParser(const char *st, ring r);
+
+    bool parseExpr(poly &res);
+    bool parseList(poly *&res, int &len);
+    bool parseVector(poly &res);
+    bool atEnd();
+    bool skipChar(char c);
+
+  private:
+    bool parseTerm(poly &res);
+    bool parseFactor(poly &res);
+    bool parsePower(poly &res);
+    bool parsePrimary(poly &res, bool &compound);
+    bool parseNumber(poly &res);
+    bool parseMonomial(poly &res, bool &compound);
+    bool parseUInt(long &res);
+    bool matchVariable(int &var);
+
+    void skipSpace();
+    long maxExp(poly p);
+
+    const char *pos;
+    ring r;
+    bool shortNames;
+};
+
+static inline bool IsIdentChar(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+SingPolyParser::SingPolyParser(const char *st, ring rr) : pos(st), r(rr)
+{
+    shortNames = true;
+    for (int i = 0; i < rVar(r); i++) {
+        if (strlen(rRingVar(i, r)) != 1) {
+            shortNames = false;
+            break;
+        }
+    }
+}
+
+void SingPolyParser::skipSpace()
+{
+    while (isspace((unsigned char)*pos))
+        pos++;
+}
+
+bool SingPolyParser::atEnd()
+{
+    skipSpace();
+    return *pos == 0;
+}
+
+bool SingPolyParser::skipChar(char c)
+{
+    skipSpace();
+    if (*pos != c)
+        return false;
+    pos++;
+    return true;
+}
+
+/// Largest exponent of any variable occuring in p; used to refuse
+/// products and powers which would overflow the exponent vectors.
+long SingPolyParser::maxExp(poly p)
+{
+    long m = 0;
+    for (; p != NULL; p = pNext(p))
+        for (int i = 1; i <= rVar(r); i++)
+            if (p_GetExp(p, i, r) > m)
+                m = p_GetExp(p, i, r);
+    return m;
+}
+
+bool SingPolyParser::parseUInt(long &res)
+{
+    skipSpace();
+    if (!isdigit((unsigned char)*pos))
+        return false;
+    res = 0;
+    while (isdigit((unsigned char)*pos)) {
+        res = 10 * res + (*pos - '0');
+        if (res > (long)r->bitmask)
+            return false;
+        pos++;
+    }
+    return true;
+}
+
+bool SingPolyParser::parseNumber(poly &res)
+{
+    const char *start = pos;
+    while (isdigit((unsigned char)*pos))
+        pos++;
+    // Hand only the digits to n_Read, as it would otherwise also
+    // consume a following '/' on its own terms.
+    std::string tok(start, pos - start);
+    number n;
+    n_Read(tok.c_str(), &n, r->cf);
+    res = p_NSet(n, r);
+    return true;
+}
+
+/// Match the longest ring variable name at the current position.
+/// In short mode, this is just a single letter.
+bool SingPolyParser::matchVariable(int &var)
+{
+    size_t best = 0;
+    var = 0;
+    for (int i = 0; i < rVar(r); i++) {
+        const char *name = rRingVar(i, r);
+        size_t len = strlen(name);
+        if (len <= best || strncmp(pos, name, len) != 0)
+            continue;
+        if (!shortNames && IsIdentChar(name[len-1]) && IsIdentChar(pos[len]))
+            continue;
+        best = len;
+        var = i + 1;
+    }
+    if (var == 0)
+        return false;
+    pos += best;
+    return true;
+}
+
+/// Parse a monomial, i.e., a single variable, or, in short mode, a
+/// sequence of variables each followed by an optional exponent.
+/// compound is set if the monomial consists of more than a single
+/// variable; a following '^' would then be ambiguous.
+bool SingPolyParser::parseMonomial(poly &res, bool &compound)
+{
+    int var;
+    if (!matchVariable(var))
+        return false;
+    res = p_One(r);
+    compound = false;
+    while (true) {
+        long e = 1;
+        if (shortNames && isdigit((unsigned char)*pos)) {
+            compound = true;
+            e = 0;
+            while (isdigit((unsigned char)*pos)) {
+                e = 10 * e + (*pos - '0');
+                pos++;
+                if (e + p_GetExp(res, var, r) > (long)r->bitmask) {
+                    p_Delete(&res, r);
+                    return false;
+                }
+            }
+        }
+        if (e + p_GetExp(res, var, r) > (long)r->bitmask) {
+            p_Delete(&res, r);
+            return false;
+        }
+        p_AddExp(res, var, e, r);
+        if (!shortNames || !isalpha((unsigned char)*pos))
+            break;
+        if (!matchVariable(var)) {
+            p_Delete(&res, r);
+            return false;
+        }
+        compound = true;
+    }
+    p_Setm(res, r);
+    return true;
+}
+
+/// Parse the inside of a vector "[p1, p2, ...]" into p1*gen(1)+p2*gen(2)+...
+bool SingPolyParser::parseVector(poly &res)
+{
+    poly *entries;
+    int len;
+    if (!parseList(entries, len))
+        return false;
+    res = NULL;
+    bool ok = true;
+    for (int i = 0; i < len; i++) {
+        poly p = entries[i];
+        if (ok && p_MaxComp(p, r) > 0)
+            ok = false;
+        if (!ok) {
+            p_Delete(&p, r);
+            continue;
+        }
+        for (poly q = p; q != NULL; q = pNext(q)) {
+            p_SetComp(q, i + 1, r);
+            p_SetmComp(q, r);
+        }
+        res = p_Add_q(res, p, r);
+    }
+    omFreeSize(entries, len * sizeof(poly));
+    if (!ok)
+        p_Delete(&res, r);
+    return ok;
+}
+
+bool SingPolyParser::parsePrimary(poly &res, bool &compound)
+{
+    skipSpace();
+    compound = false;
+    if (*pos == '(') {
+        pos++;
+        if (!parseExpr(res))
+            return false;
+        if (!skipChar(')')) {
+            p_Delete(&res, r);
+            return false;
+        }
+        return true;
+    }
+    if (*pos == '[') {
+        pos++;
+        if (!parseVector(res))
+            return false;
+        if (!skipChar(']')) {
+            p_Delete(&res, r);
+            return false;
+        }
+        return true;
+    }
+    if (isdigit((unsigned char)*pos)) {
+        parseNumber(res);
+        // Short syntax like "3xy2": a coefficient directly followed
+        // by a monomial.
+        if (shortNames && isalpha((unsigned char)*pos)) {
+            poly m;
+            if (!parseMonomial(m, compound)) {
+                p_Delete(&res, r);
+                return false;
+            }
+            res = p_Mult_q(res, m, r);
+            compound = true;
+        }
+        return true;
+    }
+    if (isalpha((unsigned char)*pos)) {
+        const char *start = pos;
+        if (parseMonomial(res, compound))
+            return true;
+        pos = start;
+        if (strncmp(pos, "gen", 3) == 0 && !IsIdentChar(pos[3])) {
+            pos += 3;
+            long i;
+            if (!skipChar('(') || !parseUInt(i) || i == 0 || !skipChar(')'))
+                return false;
+            res = p_One(r);
+            p_SetComp(res, i, r);
+            p_SetmComp(res, r);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SingPolyParser::parsePower(poly &res)
+{
+    bool compound;
+    if (!parsePrimary(res, compound))
+        return false;
+    skipSpace();
+    if (*pos != '^')
+        return true;
+    pos++;
+    long e;
+    if (compound || !parseUInt(e)) {
+        p_Delete(&res, r);
+        return false;
+    }
+    long m = maxExp(res);
+    if (p_MaxComp(res, r) > 0 && e != 1) {
+        p_Delete(&res, r);
+        return false;
+    }
+    if (m > 0 && e > (long)r->bitmask / m) {
+        p_Delete(&res, r);
+        return false;
+    }
+    res = p_Power(res, e, r);
+    return true;
+}
+
+bool SingPolyParser::parseFactor(poly &res)
+{
+    skipSpace();
+    if (*pos == '-') {
+        pos++;
+        if (!parseFactor(res))
+            return false;
+        res = p_Neg(res, r);
+        return true;
+    }
+    if (*pos == '+') {
+        pos++;
+        return parseFactor(res);
+    }
+    return parsePower(res);
+}
+
+bool SingPolyParser::parseTerm(poly &res)
+{
+    if (!parseFactor(res))
+        return false;
+    while (true) {
+        skipSpace();
+        char op = *pos;
+        if (op != '*' && op != '/')
+            return true;
+        pos++;
+        poly q;
+        if (!parseFactor(q)) {
+            p_Delete(&res, r);
+            return false;
+        }
+        if (op == '*') {
+            if ((p_MaxComp(res, r) > 0 && p_MaxComp(q, r) > 0) ||
+                maxExp(res) + maxExp(q) > (long)r->bitmask) {
+                p_Delete(&res, r);
+                p_Delete(&q, r);
+                return false;
+            }
+            res = p_Mult_q(res, q, r);
+        } else {
+            if (q == NULL || !p_IsConstant(q, r)) {
+                p_Delete(&res, r);
+                p_Delete(&q, r);
+                return false;
+            }
+            res = p_Div_nn(res, pGetCoeff(q), r);
+            p_Delete(&q, r);
+        }
+    }
+}
+
+bool SingPolyParser::parseExpr(poly &res)
+{
+    if (!parseTerm(res))
+        return false;
+    while (true) {
+        skipSpace();
+        char op = *pos;
+        if (op != '+' && op != '-')
+            return true;
+        pos++;
+        poly q;
+        if (!parseTerm(q)) {
+            p_Delete(&res, r);
+            return false;
+        }
+        if (op == '-')
+            q = p_Neg(q, r);
+        res = p_Add_q(res, q, r);
+    }
+}
+
+/// Parse a non-empty comma separated list of expressions into an
+/// omalloc'ed array of polys of length len.
+bool SingPolyParser::parseList(poly *&res, int &len)
+{
+    int cap = 16;
+    len = 0;
+    res = (poly *)omAlloc(cap * sizeof(poly));
+    do {
+        poly p;
+        if (!parseExpr(p)) {
+            for (int i = 0; i < len; i++)
+                p_Delete(&res[i], r);
+            omFreeSize(res, cap * sizeof(poly));
+            return false;
+        }
+        if (len == cap) {
+            res = (poly *)omReallocSize(res, cap * sizeof(poly),
+                                        2 * cap * sizeof(poly));
+            cap *= 2;
+        }
+        res[len++] = p;
+    } while (skipChar(','));
+    // Shrink to the exact size, so that callers can free it easily.
+    res = (poly *)omReallocSize(res, cap * sizeof(poly), len * sizeof(poly));
+    return true;
+}
+
+
+/// Return the Singular ring of rr if our parser can handle it, and
+/// NULL otherwise.
+static ring _SI_ParserRing(Obj rr)
+{
+    rr = UnwrapHighlevelWrapper(rr);
+    if (TNUM_OBJ(rr) != T_SINGULAR)
+        _SI_ErrorQuit("ring must be a Singular ring", 0L, 0L);
+    if (!ISSINGOBJ(SINGTYPE_RING_IMM, rr))
+        return NULL;  // e.g. a qring: leave it to the interpreter
+    ring r = (ring)CXX_SINGOBJ(rr);
+    if (!(rField_is_Q(r) || rField_is_Zp(r)) || rIsPluralRing(r))
+        return NULL;
+    return r;
+}
+
+static void _SI_CheckString(Obj st)
+{
+    if (!IS_STRING_REP(st))
+        _SI_ErrorQuit("argument must be a string", 0L, 0L);
+}
+
+/// Installed as SI_poly method
+Obj Func_SI_poly_from_String(Obj self, Obj rr, Obj st)
+{
+    _SI_CheckString(st);
+    ring r = _SI_ParserRing(rr);
+    if (r == NULL)
+        return Fail;
+    if (r != currRing) rChangeCurrRing(r);
+
+    SingPolyParser parser((const char *)CHARS_STRING(st), r);
+    poly p;
+    if (!parser.parseExpr(p))
+        return Fail;
+    if (!parser.atEnd() || p_MaxComp(p, r) > 0) {
+        p_Delete(&p, r);
+        return Fail;
+    }
+    return NEW_SINGOBJ_RING(SINGTYPE_POLY, p, r);
+}
+
+/// Installed as SI_vector method. Like the interpreter version, this
+/// expects the entries of the vector without the enclosing brackets.
+Obj Func_SI_vector_from_String(Obj self, Obj rr, Obj st)
+{
+    _SI_CheckString(st);
+    ring r = _SI_ParserRing(rr);
+    if (r == NULL)
+        return Fail;
+    if (r != currRing) rChangeCurrRing(r);
+
+    SingPolyParser parser((const char *)CHARS_STRING(st), r);
+    poly p;
+    if (!parser.parseVector(p))
+        return Fail;
+    if (!parser.atEnd()) {
+        p_Delete(&p, r);
+        return Fail;
+    }
+    return NEW_SINGOBJ_RING(SINGTYPE_VECTOR, p, r);
+}
+
+/// Installed as SI_ideal method
+Obj Func_SI_ideal_from_String(Obj self, Obj rr, Obj st)
+{
+    _SI_CheckString(st);
+    ring r = _SI_ParserRing(rr);
+    if (r == NULL)
+        return Fail;
+    if (r != currRing) rChangeCurrRing(r);
+
+    SingPolyParser parser((const char *)CHARS_STRING(st), r);
+    poly *polys;
+    int len;
+    if (!parser.parseList(polys, len))
+        return Fail;
+    bool ok = parser.atEnd();
+    for (int i = 0; ok && i < len; i++)
+        if (p_MaxComp(polys[i], r) > 0)
+            ok = false;
+    if (!ok) {
+        for (int i = 0; i < len; i++)
+            p_Delete(&polys[i], r);
+        omFreeSize(polys, len * sizeof(poly));
+        return Fail;
+    }
+    ideal id = idInit(len, 1);
+    memcpy(id->m, polys, len * sizeof(poly));
+    omFreeSize(polys, len * sizeof(poly));
+    return NEW_SINGOBJ_RING(SINGTYPE_IDEAL, id, r);
+}
+
+/// Installed as SI_matrix method. The entries are filled in row by
+/// row; missing entries are zero.
+Obj Func_SI_matrix_from_String(Obj self, Obj rr, Obj nrrows, Obj nrcols, Obj st)
+{
+    _SI_CheckString(st);
+    if (!IS_INTOBJ(nrrows) || !IS_INTOBJ(nrcols) ||
+        INT_INTOBJ(nrrows) <= 0 || INT_INTOBJ(nrcols) <= 0)
+        _SI_ErrorQuit("nrrows and nrcols must be positive integers", 0L, 0L);
+    ring r = _SI_ParserRing(rr);
+    if (r == NULL)
+        return Fail;
+    if (r != currRing) rChangeCurrRing(r);
+
+    Int rows = INT_INTOBJ(nrrows);
+    Int cols = INT_INTOBJ(nrcols);
+    SingPolyParser parser((const char *)CHARS_STRING(st), r);
+    matrix mat = mpNew(rows, cols);
+    if (parser.atEnd())
+        return NEW_SINGOBJ_RING(SINGTYPE_MATRIX, mat, r);
+
+    poly *polys;
+    int len;
+    if (!parser.parseList(polys, len)) {
+        id_Delete((ideal *)&mat, r);
+        return Fail;
+    }
+    bool ok = parser.atEnd() && len <= rows * cols;
+    for (int i = 0; ok && i < len; i++)
+        if (p_MaxComp(polys[i], r) > 0)
+            ok = false;
+    if (!ok) {
+        for (int i = 0; i < len; i++)
+            p_Delete(&polys[i], r);
+        omFreeSize(polys, len * sizeof(poly));
+        id_Delete((ideal *)&mat, r);
+        return Fail;
+    }
+    memcpy(mat->m, polys, len * sizeof(poly));
+    omFreeSize(polys, len * sizeof(poly));
+    return NEW_SINGOBJ_RING(SINGTYPE_MATRIX, mat, r);
+}
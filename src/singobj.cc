@@ -28,6 +28,8 @@
 #include <Singular/ipid.h>
 #include <Singular/lists.h>
 
+#include <limits.h>
+
 
 /// This function returns the Singular object referenced by the proxy
 /// object. This function implements the recursion needed for deeply
@@ -150,15 +152,62 @@ void *FOLLOW_SUBOBJ(Obj proxy, int pos, void *current, int &currgtype,
     }
 }
 
-void SingObj::init(Obj input, ring &r)
+// If the GAP integer input is small enough to be an immediate bigint
+// in Singular, return it as such, otherwise NULL. Singular expects
+// bigints in that range to be immediate, so they must not be viewed.
+static number ImmediateBigint(Obj input)
+{
+    if (SIZE_INT(input) != 1)
+        return NULL;
+    UInt v = ((UInt *)ADDR_INT(input))[0];
+    if (v > (UInt)LONG_MAX)
+        return NULL;
+    long l = (TNUM_OBJ(input) == T_INTPOS) ? (long)v : -(long)v;
+    number n = n_Init(l, coeffs_BIGINT);
+    if (SR_HDL(n) & SR_INT)
+        return n;
+    n_Delete(&n, coeffs_BIGINT);
+    return NULL;
+}
+
+void SingObj::init(Obj input, ring &r, bool borrow)
 {
     error = NULL;
     needcleanup = false;
+    borrowed = false;
     obj.Init();
 
     input = UnwrapHighlevelWrapper(input);
 
-    if (IS_INTOBJ(input) ||
+    number imm = NULL;
+    if (borrow &&
+        (TNUM_OBJ(input) == T_INTPOS || TNUM_OBJ(input) == T_INTNEG) &&
+        (imm = ImmediateBigint(input)) != NULL) {
+        obj.data = (void *)imm;
+        obj.rtyp = BIGINT_CMD;
+    } else if (borrow &&
+        (TNUM_OBJ(input) == T_INTPOS || TNUM_OBJ(input) == T_INTNEG)) {
+        // Let the mpz_t point directly at the limbs of the GAP integer.
+        // This is fine as long as nobody writes to it, and no garbage
+        // collection moves the bag.
+        UInt size = SIZE_INT(input);
+        number n = ALLOC_RNUMBER();
+        n->z->_mp_alloc = (int)size;
+        n->z->_mp_size = (TNUM_OBJ(input) == T_INTPOS) ? (int)size : - (int)size;
+        n->z->_mp_d = (mp_limb_t *)ADDR_INT(input);
+        #if defined(LDEBUG)
+        n->debug = 123456;
+        #endif
+        n->s = 3;  // indicates an integer
+        obj.data = (void *)n;
+        obj.rtyp = BIGINT_CMD;
+        borrowed = true;
+    } else if (borrow && TNUM_OBJ(input) == T_STRING) {
+        // GAP strings are always null terminated.
+        obj.data = (void *)CHARS_STRING(input);
+        obj.rtyp = STRING_CMD;
+        borrowed = true;
+    } else if (IS_INTOBJ(input) ||
         TNUM_OBJ(input) == T_INTPOS || TNUM_OBJ(input) == T_INTNEG) {
         int gtype = _SI_BIGINT_OR_INT_FROM_GAP(input, obj);
         if (gtype != SINGTYPE_INT && gtype != SINGTYPE_INT_IMM) {
@@ -174,6 +223,12 @@ void SingObj::init(Obj input, ring &r)
         needcleanup = true;
     } else if (TNUM_OBJ(input) == T_SINGULAR) {
         int gtype = TYPE_SINGOBJ(input);
+        if (GAPtoSingType[gtype] == 0) {
+            // e.g. polynomial accumulators, see accumulator.cc
+            obj.Init();
+            error = "object has no counterpart in the Singular interpreter";
+            return;
+        }
         obj.data = CXX_SINGOBJ(input);
         obj.rtyp = GAPtoSingType[gtype];
         obj.flag = FLAGS_SINGOBJ(input);
@@ -230,11 +285,34 @@ leftv SingObj::destructiveuse(ring r)
     sleftv tmp = obj;
     if (r != currRing) rChangeCurrRing(r);
     obj.Copy(&tmp);
+    if (borrowed) {
+        // obj now is a real copy, so get rid of the view
+        sleftv copy = obj;
+        obj = tmp;
+        releaseview();
+        obj = copy;
+    }
     return &obj;
 }
 
+/// Release a view created by init() in borrowed mode. Only the
+/// container is freed, the data belongs to GAP.
+void SingObj::releaseview()
+{
+    borrowed = false;
+    if (obj.rtyp == BIGINT_CMD) {
+        number n = (number)obj.data;
+        FREE_RNUMBER(n);
+    }
+    obj.Init();
+}
+
 void SingObj::cleanup()
 {
+    if (borrowed) {
+        releaseview();
+        return;
+    }
     if (!needcleanup)
         return;
     needcleanup = false;
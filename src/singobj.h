@@ -50,6 +50,22 @@ void *FOLLOW_SUBOBJ(Obj proxy, int pos, void *current, int &currgtype,
 /// object is *not* copied. Use .copy afterwards if you want to hand
 /// the result to something destructive.
 ///
+/// In borrowed mode (see init), long GAP integers and GAP strings are
+/// not copied at all: the Singular object is a read-only view of the
+/// limbs resp. characters stored inside the GAP bag. Since GASMAN may
+/// move bags around, a view must not be read after any GAP allocation,
+/// e.g. wrapping a result (gapwrap, NEW_SINGOBJ) or creating a GAP
+/// string. Releasing it afterwards is fine, as that does not read the
+/// borrowed data. So all Singular code using the views has to run
+/// before the first allocation: Singular output is buffered during a
+/// call (see EndPrintCapture), and only then is the result wrapped,
+/// while the views may still be alive (as in SI_CallProc and
+/// _SI_CallFunc1). Func_SI_CallFuncBatch, whose later calls borrow
+/// again, wraps the results only after all calls are done.
+/// _SI_ErrorQuit runs the registered cleanups before it allocates
+/// anything. destructiveuse() always produces a real copy. Integers
+/// which Singular stores as immediate values are never borrowed.
+///
 /// Note that if an error occurs, GAP will do a longjmp, so we cannot
 /// rely on automatic destruction any more, we have to call cleanup
 /// ourselves! This is why the error cannot be handled directly
@@ -64,18 +80,24 @@ private:
     /// if this is true we have to destruct the Singular object when this object dies.
     bool needcleanup;
 
+    /// if this is true, obj is a view of data inside a GAP bag.
+    bool borrowed;
+
+    void releaseview();
+
 public:
     SingObj(Obj input, ring &r) {
         init(input, r);
     }
 
     /// Default constructor for empty object
-    SingObj() : error(NULL), needcleanup(false) {
+    SingObj() : error(NULL), needcleanup(false), borrowed(false) {
         obj.Init();
     }
 
-    // This does the actual work
-    void init(Obj input, ring &r);
+    // This does the actual work. If borrow is true, big integers and
+    // strings are not copied but referenced in place, see above.
+    void init(Obj input, ring &r, bool borrow = false);
 
     ~SingObj() {
         cleanup();
@@ -84,7 +84,9 @@ const int GAPtoSingType[] = {
     0, /* USERDEF */
     0, /* USERDEF */
     0, /* PYOBJECT */
-    0 /* PYOBJECT */
+    0, /* PYOBJECT */
+    0, /* POLYACC */
+    0  /* POLYACC */
 };
 
 int SingtoGAPType[MAX_TOK];
@@ -140,9 +142,11 @@ const int HasRingTable[] = {
     // TODO (?): fan
     // TODO (?): polytope
     0, // SINGTYPE_PYOBJECT      = 46,
-    0  // SINGTYPE_PYOBJECT_IMM  = 47,
+    0, // SINGTYPE_PYOBJECT_IMM  = 47,
     // TODO (?): reference
     // TODO (?): shared
+    1, // SINGTYPE_POLYACC       = 48,
+    1  // SINGTYPE_POLYACC_IMM   = 49,
 };
 
 
@@ -212,6 +216,8 @@ void InitSingTypesFromKernel()
     AssPRec(tmp, RNamName("SINGTYPE_PYOBJECT_IMM"), INTOBJ_INT(SINGTYPE_PYOBJECT_IMM));
     // TODO (?): reference
     // TODO (?): shared
+    AssPRec(tmp, RNamName("SINGTYPE_POLYACC"), INTOBJ_INT(SINGTYPE_POLYACC));
+    AssPRec(tmp, RNamName("SINGTYPE_POLYACC_IMM"), INTOBJ_INT(SINGTYPE_POLYACC_IMM));
     gvar = GVarName("_SI_TYPENRS");
     MakeReadWriteGVar(gvar);
     AssGVar(gvar, tmp);
@@ -80,7 +80,11 @@ enum SingType {
     // TODO (?): reference
     // TODO (?): shared
 
-    SINGTYPE_LASTNUMBER    = 47
+    // Types without a counterpart in the Singular interpreter:
+    SINGTYPE_POLYACC       = 48,
+    SINGTYPE_POLYACC_IMM   = 49,
+
+    SINGTYPE_LASTNUMBER    = 49
 };
 
 
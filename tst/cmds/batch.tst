@@ -0,0 +1,11 @@
+gap> r := SI_ring(0,["x","y"]);
+<singular ring, 2 indeterminates>
+gap> G := SI_std(SI_ideal(r,"x2-y,xy-1"));;
+gap> gens := [SI_poly(r,"x3"), SI_poly(r,"x2y+y2"), SI_poly(r,"y")];;
+gap> res := SI_CallBatch("reduce", List(gens, g -> [g, G]));;
+gap> res = List(gens, g -> SI_reduce(g, G));
+true
+gap> SI_CallBatch("deg", [[gens[1]], [gens[2]], [Zero(gens[1])]]);
+[ 3, 3, -1 ]
+gap> SI_CallBatch("nrows", [[SI_matrix(r,2,3,"x,y")], [SI_intvec([1,2,3])]]);
+[ 2, 3 ]
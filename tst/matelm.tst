@@ -53,3 +53,18 @@ gap> _SI_MatElm(m3, 1, 3);
 42*x^3+23*x^2
 gap> m3;
 <singular matrix, 2x3>
+gap> 
+gap> # copies share their payload until one of them is modified
+gap> m6 := SI_intmat([[1,2],[3,4]]);;
+gap> m7 := ShallowCopy(m6);;
+gap> m8 := StructuralCopy(m6);;
+gap> _SI_SetMatElm(m7, 1, 1, 7);
+gap> _SI_SetMatElm(m6, 2, 2, 9);
+gap> m6;
+<singular intmat:[ [ 1, 2 ], [ 3, 9 ] ]>
+gap> m7;
+<singular intmat:[ [ 7, 2 ], [ 3, 4 ] ]>
+gap> m8;
+<singular intmat:[ [ 1, 2 ], [ 3, 4 ] ]>
+gap> IsMutable(MakeImmutable(ShallowCopy(m8)));
+false
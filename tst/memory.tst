@@ -0,0 +1,122 @@
+gap> old := SI_GCPolicy();;
+gap> SortedList(RecNames(old));
+[ "freebudget", "full", "fullratio", "young" ]
+gap> SI_SetGCPolicy(rec(young := 10000, fullratio := 2));
+gap> p := SI_GCPolicy();;
+gap> [p.young, p.fullratio, p.full = old.full];
+[ 10000, 2, true ]
+gap> r := SI_ring(0,["x","y"]);;
+gap> l := List([1..200], i -> SI_poly(r, Concatenation("(x+y)^", String(i mod 20))));;
+gap> ForAll(l, IsSI_poly);
+true
+gap> SI_SetGCPolicy(rec(freebudget := 1));
+gap> l := List([1..100], i -> SI_ideal(SI_ring(0,["a","b"]), "a2,ab,b2"));;
+gap> Unbind(l);; GASMAN("collect");
+gap> l := List([1..100], i -> SI_poly(r, "x2+y"));;
+gap> Sum(l) = 100 * SI_poly(r, "x2+y");
+true
+gap> SI_SetGCPolicy(rec(freebudget := 0));
+gap> Unbind(l);; GASMAN("collect");
+gap> SI_GCPolicy().freebudget;
+0
+gap> SI_SetGCPolicy(rec(fullratio := 0));
+Error, SI_SetGCPolicy: fullratio must be positive
+gap> SI_SetGCPolicy(rec(young := -1));
+Error, SI_SetGCPolicy: component young must be a non-negative integer
+gap> SI_SetGCPolicy(old);
+gap> SI_GCPolicy() = old;
+true
+
+# Memory statistics
+gap> SI_ByteSize(Zero(SI_poly(r, "x")));
+0
+gap> SI_ByteSize(SI_poly(r, "x+y+1")) > SI_ByteSize(SI_poly(r, "x"));
+true
+gap> SI_ByteSize(SI_poly(r, "x+y")) = 2 * SI_ByteSize(SI_poly(r, "x"));
+true
+gap> s := SI_ring(0,["a","b","c"]);;
+gap> SI_ResetMemoryStats();
+gap> l := List([1..10], i -> SI_ideal(s, "a2,ab,bc"));;
+gap> st := SI_MemoryStats();;
+gap> SortedList(RecNames(st));
+[ "pending", "rings", "total", "types" ]
+gap> rs := First(st.rings, x -> IsIdenticalObj(x.ring, s));;
+gap> rs.count >= 10 and rs.bytes >= Sum(l, SI_ByteSize);
+true
+gap> st.types.ideal.count >= 10 and st.types.ideal.peak >= st.types.ideal.bytes;
+true
+gap> st.total.bytes >= rs.bytes;
+true
+gap> SI_ByteSize(1);
+Error, SI_ByteSize: argument must be a Singular object
+
+# Memory limit
+gap> SI_MemoryLimitExceeded;
+<singular failure: memory limit exceeded>
+gap> SingularUnbind("memtst");Singular("proc memtst(a){return(a);}");
+true
+gap> Singular("proc memhog(){list l; int i; for(i=1;i<=20000;i++){l=insert(l,i);} return(size(l));}");
+true
+gap> SI_SetMemoryLimit(10^8);
+gap> SI_std(SI_ideal(r, "x2-y,xy-1"));
+<singular ideal, 3 gens>
+gap> SI_CallProc("memtst", [1]);
+1
+gap> SI_SetMemoryLimit(1);
+gap> IsIdenticalObj(SI_CallProc("memhog", []), SI_MemoryLimitExceeded);
+true
+gap> SI_SetMemoryLimit(0);
+gap> SI_std(SI_ideal(r, "x2-y,xy-1"));
+<singular ideal, 3 gens>
+gap> SI_SetMemoryLimit(-1);
+Error, SI_SetMemoryLimit: argument must be a non-negative integer
+
+# GC statistics
+gap> SI_ResetGCStats();
+gap> st := SI_GCStats();;
+gap> [st.forcedpartial, st.forcedfull, st.ringsqueued, st.objectsfreed];
+[ 0, 0, 0, 0 ]
+gap> l := List([1..20], i -> SI_ring(0, ["u"]));;
+gap> l := List([1..20], i -> SI_poly(r, "x2+y"));;
+gap> Unbind(l);; GASMAN("collect"); GASMAN("collect");
+gap> st := SI_GCStats();;
+gap> st.collections >= 1 and st.ringsqueued >= 20 and st.ringskilled >= 20;
+true
+gap> st.freedbytype.poly >= 20 and st.objectsfreed >= 20;
+true
+
+# Memoization
+gap> SI_SetMemoLimit(10^6);
+gap> h := SI_MemoStats().hits;;
+gap> i1 := MakeImmutable(SI_ideal(r, "x2-y,xy-1"));;
+gap> i2 := MakeImmutable(SI_ideal(r, "x2-y,xy-1"));;
+gap> s1 := SI_std(i1);; s2 := SI_std(i2);;
+gap> SI_MemoStats().hits - h;
+1
+gap> IsIdenticalObj(s1, s2) or not IsMutable(s2);
+false
+gap> SI_std(SI_ideal(r, "x2-y,xy-1"));;
+gap> SI_MemoStats().hits - h;
+1
+gap> SI_MemoizeProcs(["memtst"]);
+gap> SI_CallProc("memtst", [5]);; SI_CallProc("memtst", [5]);
+5
+gap> SI_MemoStats().hits - h;
+2
+gap> Singular("1+2;");
+true
+gap> SI_CallProc("memtst", [5]);
+5
+gap> SingularLastOutput();
+""
+gap> SI_MemoStats().hits - h;
+3
+gap> Singular("proc memtst(a){return(a+1);}");
+true
+gap> SI_CallProc("memtst", [5]);
+6
+gap> SI_MemoStats().hits - h;
+3
+gap> SI_SetMemoLimit(0);
+gap> SI_MemoStats().entries;
+0
@@ -52,3 +52,68 @@ gap> ai-b;
 <singular matrix, 3x3>
 gap> ai-bi;
 <singular matrix, 3x3>
+gap> IsMutable(ai*bi);
+false
+gap> IsMutable(ai*b);
+true
+gap> IsMutable(-ai);
+false
+gap> IsMutable(-a);
+true
+gap> p := SI_poly(r,"x+y");;
+gap> pi := MakeImmutable(SI_poly(r,"x-y"));;
+gap> p*pi;
+x^2-y^2
+gap> IsMutable(p*pi);
+true
+gap> IsMutable(pi*pi);
+false
+gap> IsMutable(2*pi);
+false
+gap> IsMutable(pi^2);
+false
+gap> IsMutable(p^2);
+true
+gap> 3 - pi;
+-x+y+3
+gap> p*SI_vector(r, "1,x,y,z");
+<singular vector, 4 entries>
+gap> n := MakeImmutable(SI_number(r, 3));;
+gap> n / SI_number(r, 6);
+<singular number: 1/2>
+gap> IsMutable(n / n);
+false
+gap> q := SI_poly(r,"x2");;
+gap> q2 := ShallowCopy(q);;
+gap> SI_AddInPlace(q, pi);
+gap> q;
+x^2+x-y
+gap> q2;
+x^2
+gap> SI_AddScaledInPlace(q, -1, SI_poly(r,"x"), pi);
+gap> q;
+x*y+x-y
+gap> SI_MultInPlace(q, 2);
+gap> q;
+2*x*y+2*x-2*y
+gap> SI_MultInPlace(q, SI_poly(r,"z"));
+gap> q;
+2*x*y*z+2*x*z-2*y*z
+gap> SI_AddInPlace(q, q);
+gap> q;
+4*x*y*z+4*x*z-4*y*z
+gap> SI_MultInPlace(q, 0);
+gap> q;
+0
+gap> SI_AddInPlace(pi, q);
+Error, <a> must be mutable
+gap> SI_MultInPlace(q, p);
+Error, <c> must be a scalar over the ring of <a>
+gap> m := SIC_IdentityMat(r,3);;
+gap> SI_AddScaledInPlace(m, 2, SI_poly(r,"1"), ai);
+gap> _SI_MatElm(m, 1, 1);
+3
+gap> _SI_MatElm(m, 1, 2);
+0
+gap> SI_AddInPlace(m, SIC_IdentityMat(r,2));
+Error, <a> and <b> must have the same size
@@ -52,3 +52,51 @@ gap> Singular("if(defined(myRingMaker)){kill myRingMaker;};proc myRingMaker(){ri
 true
 gap> t := SI_CallProc("myRingMaker", []);
 <singular ring, 1 indeterminate>
+
+# Output capture modes
+gap> SingularUnbind("pprint");Singular("proc pprint(a){print(a);return(a);}");
+true
+gap> SI_SetOutputCapture("lazy");
+gap> SI_CallProc("pprint", [17]);
+17
+gap> SingularLastOutput();
+"17\n"
+gap> SI_SetOutputCapture("off");
+gap> SI_CallProc("pprint", [18]);
+18
+gap> SingularLastOutput();
+""
+gap> SI_SetOutputCapture("on");
+gap> SI_CallProc("pprint", [19]);
+19
+gap> SingularLastOutput();
+"19\n"
+gap> SI_SetOutputCapture("sometimes");
+Error, mode must be one of "on", "lazy" or "off"
+
+# Proc handles
+gap> h := SI_ProcHandle("p2");
+<singular proc handle for p2>
+gap> SI_CallProc(h, [1,2]);
+[ 1, 2 ]
+gap> SingularUnbind("p2");Singular("proc p2(a,b){return(b,a);}");
+true
+gap> SI_CallProc(h, [1,2]);
+[ 2, 1 ]
+gap> g := _SI_ProcGeneration();;
+gap> SI_CallProc("p0", []);
+42
+gap> SI_CallProc(h, [1,2]);
+[ 2, 1 ]
+gap> _SI_ProcGeneration() = g;
+true
+gap> Singular("proc killp2(){kill p2;}");
+true
+gap> g := _SI_ProcGeneration();;
+gap> SI_CallProc("killp2", []);;
+gap> _SI_ProcGeneration() > g;
+true
+gap> SI_CallProc(h, [1,2]);
+Error, Proc p2 not found in Singular interpreter.
+gap> SI_ProcHandle("p7");
+fail
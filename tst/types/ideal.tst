@@ -14,3 +14,33 @@ gap> Display(j);
 y^2,
 x*y,
 x^2
+gap> i := SI_ideal(r,"(x-y)^2, x*y/2, -x+3, 0");
+<singular ideal, 4 gens>
+gap> Display(i);
+x^2-2*x*y+y^2,
+1/2*x*y,
+-x+3,
+0
+gap> SI_ideal(r,"maxideal(2)");
+<singular ideal, 3 gens>
+gap> # results for immutable ideals are cached
+gap> i := MakeImmutable(SI_ideal(r,"x2,y2,xy"));;
+gap> SI_IsSB(i);
+false
+gap> j1 := SI_std(i);; j2 := SI_std(i);;
+gap> SI_IsSB(j1); SI_IsSB(j2);
+true
+true
+gap> IsIdenticalObj(j1, j2);
+false
+gap> IsMutable(j2);
+true
+gap> SI_ToGAP(j2) = SI_ToGAP(j1);
+true
+gap> j := MakeImmutable(j1);;
+gap> SI_dim(j); SI_dim(j);
+0
+0
+gap> SI_vdim(j); SI_vdim(j);
+3
+3
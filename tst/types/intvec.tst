@@ -19,3 +19,9 @@ gap> iv:=SI_intvec([1..100]);
 96, 97, 98, 99, 100 ]>
 gap> _SI_Plistintvec(iv) = [1..100];
 true
+gap> SI_intvec([1,,3]);
+Error, l must contain small integers
+gap> SI_intvec([1,2,"x"]);
+Error, l must contain small integers
+gap> SI_intvec([4,5]);
+<singular intvec:[ 4, 5 ]>
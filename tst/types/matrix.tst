@@ -53,3 +53,9 @@ gap> n := SI_matrix(2,2,[a,b,a,b]);
 <singular matrix, 2x2>
 gap> m=n;
 true
+gap> r := SI_ring(0,["x","y","z"]);;
+gap> m := SI_matrix(r, 2, 2, "x2, y, z3");
+<singular matrix, 2x2>
+gap> Display(m);
+x^2,y,
+z^3,0 
@@ -2,3 +2,50 @@ gap> s := SI_ring(32003,["x","y","z"]);
 <singular ring, 3 indeterminates>
 gap> s1 := SI_poly(s,"x2y+151xyz10+169y21");
 169*y^21+151*x*y*z^10+x^2*y
+gap> SI_poly(s, [1, 151, 169], [2,1,0, 1,1,10, 0,21,0]);
+169*y^21+151*x*y*z^10+x^2*y
+gap> SI_poly(s, [1, 2, -3], [1,0,0, 0,1,0, 1,0,0]);
+-2*x+2*y
+gap> SI_poly(s, [], []);
+0
+gap> SI_poly(s, [1], [1,2]);
+Error, exps must contain one exponent per variable for each coefficient
+gap> SI_ToGAP(s1);
+[ [ 169, 151, 1 ], [ 0, 21, 0, 1, 1, 10, 2, 1, 0 ] ]
+gap> SI_poly(s, SI_ToGAP(s1)[1], SI_ToGAP(s1)[2]) = s1;
+true
+gap> SI_ToGAP(Zero(s1));
+[ [  ], [  ] ]
+gap> q := SI_ring(0,["a","b"]);;
+gap> SI_ToGAP(SI_poly(q, [1/2, -3, 2^70], [1,1, 0,2, 0,0]));
+[ [ 1/2, -3, 1180591620717411303424 ], [ 1, 1, 0, 2, 0, 0 ] ]
+gap> p1 := SI_poly(q, "a2+b/3+12345678901234567890");;
+gap> p2 := SI_poly(q, "12345678901234567890+1/3*b+a^2");;
+gap> p1 = p2;
+true
+gap> SI_Hash(p1) = SI_Hash(p2);
+true
+gap> SI_Hash(p1) = SI_Hash(MakeImmutable(ShallowCopy(p1)));
+true
+gap> p1 = SI_poly(q, "a2+b/3");
+false
+gap> p1 = Zero(p1);
+false
+gap> SI_Hash(SI_ideal([p1, p2])) = SI_Hash(SI_ideal([p2, p1]));
+true
+gap> Length(Set(List([p1, p2, SI_poly(q, "a")], SI_Hash)));
+2
+gap> r := SI_ring(0, ["x","y"]);;
+gap> l := List(["y", "x", "x+1", "x-1", "x2", "0", "xy", "x+y"], s -> SI_poly(r, s));;
+gap> Set(l);
+[ 0, y, x, x-1, x+1, x+y, x*y, x^2 ]
+gap> SI_poly(r, "x") < SI_poly(r, "y");
+false
+gap> SI_poly(r, "y") < SI_poly(r, "x");
+true
+gap> Position(Set(l), SI_poly(r, "x+y"));
+6
+gap> SI_number(r, 1/2) < SI_number(r, 2/3);
+true
+gap> SI_bigint(3) < SI_bigint(-5);
+false
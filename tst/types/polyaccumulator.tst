@@ -0,0 +1,68 @@
+gap> r := SI_ring(0, ["x","y","z"]);
+<singular ring, 3 indeterminates>
+gap> acc := SI_PolyAccumulator(r);
+<singular poly accumulator>
+gap> SI_AccumulatorResult(acc);
+0
+gap> SI_AccumulatorAdd(acc, SI_poly(r, "x+y"));
+gap> SI_AccumulatorAdd(acc, SI_poly(r, "y+z"));
+gap> SI_AccumulatorResult(acc);
+x+2*y+z
+gap> SI_AccumulatorAddScaled(acc, -2, SI_poly(r, "1"), SI_poly(r, "y"));
+gap> SI_AccumulatorResult(acc);
+x+z
+gap> SI_AccumulatorAddScaled(acc, 1/2, SI_poly(r, "xz"), SI_poly(r, "x-z"));
+gap> Display(acc);
+1/2*x^2*z-1/2*x*z^2+x+z
+gap> p := SI_AccumulatorResult(acc);;
+gap> IsMutable(p);
+true
+gap> SI_AccumulatorAdd(acc, p);
+gap> SI_AccumulatorResult(acc) = 2*p;
+true
+gap> SI_AccumulatorAdd(acc, SI_poly(SI_ring(0, ["x"]), "x"));
+Error, <a> and <p> must be defined over the same ring
+gap> SI_AccumulatorAddScaled(acc, 1, SI_poly(r, "x+y"), p);
+Error, <m> must be a monomial over the ring of <a>
+gap> SI_AccumulatorAdd(MakeImmutable(SI_PolyAccumulator(r)), p);
+Error, <a> must be mutable
+gap> SI_RingOfSingobj(acc) = r;
+true
+gap> acc2 := ShallowCopy(acc);;
+gap> IsIdenticalObj(acc, acc2);
+false
+gap> SI_AccumulatorAdd(acc2, SI_poly(r, "y"));
+gap> SI_AccumulatorResult(acc2) - SI_AccumulatorResult(acc);
+y
+gap> SingularUnbind("pq");Singular("proc pq(){ring r=0,(x,y),dp;ideal i=xy;qring q=std(i);return(q);}");
+true
+gap> SI_PolyAccumulator(SI_CallProc("pq", []));
+Error, argument must not be a quotient ring
+gap> l := List([1..100], i -> SI_poly(r, Concatenation("x^", String(i))));;
+gap> IsIdenticalObj(ApplicableMethod(SumOp, [l]), _SI_SumPolys);
+true
+gap> IsIdenticalObj(ApplicableMethod(SumOp, [[l[1], 1]]), _SI_SumPolys);
+false
+gap> Sum(l) = SI_poly(r, JoinStringsWithSeparator(List([1..100], i -> Concatenation("x^", String(i))), "+"));
+true
+gap> Sum(l - l);
+0
+gap> IsMutable(Sum(List(l, MakeImmutable)));
+false
+gap> SI_LinearCombination([2, -1/3, SI_number(r, 3)],
+>      [SI_poly(r, "x"), SI_poly(r, "3y"), SI_poly(r, "z")]);
+2*x-y+3*z
+gap> IsMutable(last);
+true
+gap> v := SI_LinearCombination([1, -1], List([1, 2], i -> MakeImmutable(SI_vector(r, "1,x,y,z"))));
+<singular vector, 0 entries>
+gap> IsMutable(v);
+false
+gap> SI_LinearCombination([1, 0], [SI_poly(r, "x"), SI_poly(r, "y")]);
+x
+gap> SI_LinearCombination([1], [SI_poly(r, "x"), SI_poly(r, "y")]);
+Error, <coeffs> and <polys> must have the same length
+gap> SI_LinearCombination([1, 1], [SI_poly(r, "x"), SI_vector(r, "1,x")]);
+Error, the entries of <polys> must have the same type and ring
+gap> SI_LinearCombination([(), 1], [SI_poly(r, "x"), SI_poly(r, "y")]);
+Error, Argument must be an integer or rational.
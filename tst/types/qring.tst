@@ -6,3 +6,14 @@ gap> q := SI_CallProc("p0", []);
 <ring-with-one>
 gap> IsSI_qring(q);
 true
+gap> x := SI_poly(q, "x");; y := SI_poly(q, "y");;
+gap> x * y;
+0
+gap> (x + y)^2;
+x^2+y^2
+gap> SI_AddInPlace(x, y);
+Error, <a> must not be defined over a quotient ring
+gap> IsMutable(MakeImmutable(x) * MakeImmutable(y));
+false
+gap> IsMutable(MakeImmutable(x)^2);
+false